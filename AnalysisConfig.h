@@ -2,6 +2,9 @@
 // David Grund, Feb 26, 2022
 // Configure values of the parameters
 
+#ifndef AnalysisConfig_h
+#define AnalysisConfig_h
+
 #include "TSystem.h"
 #include "TString.h"
 
@@ -97,4 +100,21 @@ void InitAnalysis(Int_t iAnalysis){
     Printf("*** Results will be stored in the folder: Results/%s ***", str_subfolder.Data());
 
     return;
-}
\ No newline at end of file
+}
+
+TString AnalysisConfig_ToString()
+{
+    // all values that influence the selected samples (used as a part of the keys in StageCache.h)
+    TString str = Form("subfolder=%s;pass3=%i;PIDCalibrated=%i;NParFixed=%i;uniformBins=%i;nPtBins=%i;",
+                       str_subfolder.Data(), isPass3, isPIDCalibrated, isNParInDSCBFixed, areBinYieldsUniform, nPtBins);
+    str += Form("VertexContrib=%i;VertexZ=%.3f;Y=%.3f;Eta=%.3f;N_DSCB=%.3f;",
+                cut_fVertexContrib, cut_fVertexZ, cut_fY, cut_fEta, fN_DSCB);
+    str += "runs18q=";
+    for(Int_t i = 0; i < nRuns_18q; i++) str += Form("%i,", runList_18q[i]);
+    str += ";runs18r=";
+    for(Int_t i = 0; i < nRuns_18r; i++) str += Form("%i,", runList_18r[i]);
+
+    return str;
+}
+
+#endif
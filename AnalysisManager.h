@@ -2,6 +2,9 @@
 // David Grund, Feb 26, 2022
 // Functions to set branch addresses and to check if events pass selection criteria
 
+#ifndef AnalysisManager_h
+#define AnalysisManager_h
+
 // cpp headers
 #include <stdio.h> // printf
 // root headers
@@ -458,4 +461,6 @@ Bool_t EventPassedMCGen(Int_t iPtCut = -1, Int_t iPtBin = -1)
 
     // Event passed all the selections =>
     return kTRUE;
-}
\ No newline at end of file
+}
+
+#endif
@@ -90,7 +90,7 @@ void ReweightIncPtShape(TString process = "IncJ")
         hRatios->SetTitle("#it{R} = (#it{N}^{gen}_{MC})_{new}/(#it{N}^{gen}_{MC})_{old}");
         hRatios->Sumw2();
         hRatios->Divide(hGenOld);
-        TAxis *xAxis = hRatios->GetXaxis();
+        ReweightTable weights(hRatios);
         // plot everything
         int nRowsLeg = 2;
         bool tw = false;
@@ -138,8 +138,7 @@ void ReweightIncPtShape(TString process = "IncJ")
                 hRecOld->Fill(fPt);
                 hRecOld_fit->Fill(fPt);
                 // fill the new one using the ratios as weights
-                Int_t iBinGen = xAxis->FindBin(fPtGen);
-                Float_t weight = hRatios->GetBinContent(iBinGen);
+                Float_t weight = weights.Weight(fPtGen);
                 hRecNew->Fill(fPt,weight);
                 hRecNew_fit->Fill(fPt,weight);
                 hRec_ptFit->Fill(fPt,weight);
@@ -16,10 +16,10 @@ void AxE_PtBins(Int_t iAnalysis)
     gSystem->Exec("mkdir -p Results/" + str_subfolder + "AxE_PtBins/");
 
     // original AxE
-    AxE_PtBins_Calculate(kFALSE,cut_fVertexZ);
+    AxE_PtBins_Calculate(kFALSE);
 
     // re-weighted AxE
-    AxE_PtBins_Calculate(kTRUE,cut_fVertexZ);
+    AxE_PtBins_Calculate(kTRUE);
 
     return;
 }
\ No newline at end of file
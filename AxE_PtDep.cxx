@@ -5,6 +5,8 @@
 // cpp headers
 #include <fstream> // print output to txt file
 #include <iomanip> // std::setprecision()
+#include <vector>
+#include <algorithm> // std::find()
 // root headers
 #include "TColor.h"
 #include "TPad.h"
@@ -65,8 +67,11 @@ TString CutsLabels[nCuts-1] = {
 void CalculateAxEPtDep();
 void FillHistNRec();
 void FillHistNGen();
-void CalculateRatiosOfNRec();
-Bool_t EventPassedMCRec_AxEPtDep(Int_t iMassCut);
+void CalculateRatiosOfNRec(Bool_t cumulative = kFALSE);
+UInt_t CutFlowBits();
+TString CutFlowConfig(Bool_t ptGen, UInt_t mask);
+std::vector<TString> CutFlowConfigs();
+void FillHistNRec_CutFlow(std::vector<TString> configs);
 void SetPad(TPad* p);
 TString ConvertCutsToString();
 TString ConvertCutsToBePlottedToString();
@@ -79,6 +84,9 @@ void AxE_PtDep(Int_t iAnalysis)
     // AxE plots:
     gSystem->Exec("mkdir -p Results/" + str_subfolder + "AxE_PtDep/fig/");
 
+    // N rec for all cut configurations used below, in one pass over the MC
+    FillHistNRec_CutFlow(CutFlowConfigs());
+
     // vs pT rec, all selections:
     cuts[0] = 0;
     for(Int_t i = 1; i < nCuts; i++) cuts[i] = 1;
@@ -121,6 +129,12 @@ void AxE_PtDep(Int_t iAnalysis)
     // ratios vs pt gen
     cuts[0] = 1;
     CalculateRatiosOfNRec();
+
+    // cumulative ratios (cuts 1 to i) vs pt rec and pt gen
+    cuts[0] = 0;
+    CalculateRatiosOfNRec(kTRUE);
+    cuts[0] = 1;
+    CalculateRatiosOfNRec(kTRUE);
     //#########################################################################
 
     return;
@@ -215,29 +229,8 @@ void FillHistNRec()
         return;
     } else {
         // this configuration needs to be calculated
-        Printf("*** Calculating N_rec per bin for %s... ***", file.Data());
-
-        TFile *fRec = TFile::Open((str_in_MC_fldr_rec + "AnalysisResults_MC_kIncohJpsiToMu.root").Data(), "read");
-        if(fRec) Printf("MC rec file loaded.");
-        TTree *tRec = dynamic_cast<TTree*> (fRec->Get(str_in_MC_tree_rec.Data()));
-        if(tRec) Printf("MC rec tree loaded.");
-        ConnectTreeVariablesMCRec(tRec);
-
-        // load the ratio to re-weight the spectra
-        TH1F* hRatios = GetRatioHisto();
-        TAxis* xAxis = hRatios->GetXaxis();
-        // loop over tree entries
-        for(Int_t iEntry = 0; iEntry < tRec->GetEntries(); iEntry++) {
-            tRec->GetEntry(iEntry);
-            if(EventPassedMCRec_AxEPtDep(0)) {
-                Int_t iBinGen = xAxis->FindBin(fPtGen);
-                Float_t weight = hRatios->GetBinContent(iBinGen);
-                if(cuts[0] == kFALSE) hRec->Fill(fPt, weight);
-                if(cuts[0] == kTRUE)  hRec->Fill(fPtGen, weight);
-            }
-        }
-        Printf("*** Finished! ***");
-        SaveToFile(file,hRec);
+        FillHistNRec_CutFlow({sCutConfig});
+        if(!gSystem->AccessPathName(file.Data())) FillHistNRec();
         return;
     }
 }
@@ -274,13 +267,12 @@ void FillHistNGen()
 
         // load the ratio to re-weight the spectra
         TH1F* hRatios = GetRatioHisto();
-        TAxis* xAxis = hRatios->GetXaxis();
+        ReweightTable weights(hRatios);
         // loop over tree entries
         for(Int_t iEntry = 0; iEntry < tGen->GetEntries(); iEntry++) {
             tGen->GetEntry(iEntry);
             if(EventPassedMCGen()) {
-                Int_t iBinGen = xAxis->FindBin(fPtGen);
-                Float_t weight = hRatios->GetBinContent(iBinGen);
+                Float_t weight = weights.Weight(fPtGen);
                 hGen->Fill(fPtGen, weight);
             }
         }
@@ -290,7 +282,8 @@ void FillHistNGen()
     }
 }
 
-void CalculateRatiosOfNRec()
+// cumulative = kFALSE: each cut alone, kTRUE: cuts 1 to i (cut flow)
+void CalculateRatiosOfNRec(Bool_t cumulative)
 {
     gStyle->SetOptTitle(0);
     // Get number of bins
@@ -314,11 +307,12 @@ void CalculateRatiosOfNRec()
         cuts[i] = 1;
         hRec = new TH1F("hRec","N rec per bin",nBins,edges);
         FillHistNRec();
-        TString hName("hRecRatios_%i", i);
+        TString hName = Form("hRecRatios_%i", i);
         hRecRatios[i] = (TH1F*)hRec->Clone(hName.Data());
         delete hRec;
-        cuts[i] = 0;
+        if(!cumulative) cuts[i] = 0;
     }
+    for(Int_t i = 1; i < nCuts; i++) cuts[i] = 0;
     // Plot the results
     TH1F* hOne = new TH1F("hOne","ones",nBins,edges);
     for(Int_t i = 1; i <= nBins; i++){
@@ -390,9 +384,11 @@ void CalculateRatiosOfNRec()
     TLegend *l = new TLegend(0.0,0.1,1.0,0.98);
     //l->AddEntry(hist[0],"only S9");
     l->AddEntry(hOne,"only #it{p}_{T} sel. = 1.0","L");
-    l->AddEntry((TObject*)0,Form("with additional:"),"");
+    if(!cumulative) l->AddEntry((TObject*)0,Form("with additional:"),"");
+    else            l->AddEntry((TObject*)0,Form("with additional (cumulative):"),"");
     for(Int_t iHist = 1; iHist < nCuts; iHist++){
-        l->AddEntry(hRecRatios[iHist],Form("%s", (CutsLabels[iHist-1]).Data()),"LP");
+        if(!cumulative || iHist == 1) l->AddEntry(hRecRatios[iHist],Form("%s", (CutsLabels[iHist-1]).Data()),"LP");
+        else                          l->AddEntry(hRecRatios[iHist],Form("+ %s", (CutsLabels[iHist-1]).Data()),"LP");
     }
     l->SetTextSize(0.085);
     l->SetBorderSize(0);
@@ -400,116 +396,137 @@ void CalculateRatiosOfNRec()
     l->Draw();
     // Save the figures
     TString PlotConfiguration = ConvertCutsToBePlottedToString();
+    if(cumulative) PlotConfiguration = "cumulative_" + PlotConfiguration;
     TString Path("Results/" + str_subfolder + "AxE_PtDep/ratios/");
     cRatios->Print((Path + PlotConfiguration + ".pdf").Data());
 
     return;
 }
 
-Bool_t EventPassedMCRec_AxEPtDep(Int_t iMassCut = 0)
+// Cut-flow engine: all selections of the current event are evaluated once, the result is a bitmask:
+// bit 0 = selections that are always applied, bit i = cut i (i = 1..12, see cuts[nCuts]),
+// an event passes a configuration of cuts if it has all the bits of the configuration set
+UInt_t CutFlowBits()
 {
-    // Run number in the GoodHadronPID lists published by DPG
-    if(!RunNumberInListOfGoodRuns()) return kFALSE;
-
-    // if pass1
-    if(!isPass3){
-        // selections applied on the GRID:
-        // 0) fEvent non-empty
-        // 1) At least two tracks associated with the vertex
-        // 2) Distance from the IP lower than 15 cm
-        // 3) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
-
-    // if pass3
-    } else {
-        // selections applied on the GRID:
-        // 0) fEvent non-empty
-        // 1) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
-
-        // 2) At least two tracks associated with the vertex
-        if(fVertexContrib < cut_fVertexContrib) return kFALSE;
-
-        // 3) Distance from the IP lower than cut_fVertexZ
-        if(fVertexZ > cut_fVertexZ) return kFALSE;
-    }
-
-    // 4) central UPC trigger CCUP31:
-    // for fRunNumber < 295881: CCUP31-B-NOPF-CENTNOTRD
-    // for fRunNumber >= 295881: CCUP31-B-SPD2-CENTNOTRD
-    if(cuts[1]){ 
-        // !0VBA (no signal in the V0A)
-        // and
-        // !0VBC (no signal in the V0C)
-        if(fTriggerInputsMC[0] || fTriggerInputsMC[1]) return kFALSE;
-    }
-    if(cuts[2]){ 
-        // !0UBA (no signal in the ADA)
-        // and
-        // !0UBC (no signal in the ADC)
-        if(fTriggerInputsMC[2] || fTriggerInputsMC[3]) return kFALSE;
-    }
-    if(cuts[3]){ 
-        // 0STG (SPD topological)
-        if(!fTriggerInputsMC[10]) return kFALSE;
-    }
-    if(cuts[4]){ 
-        // 0OMU (TOF two hits topology)
-        if(!fTriggerInputsMC[4]) return kFALSE;
-    }
+    UInt_t bits = 0;
 
+    // always applied:
+    Bool_t base = kTRUE;
+    // Run number in the GoodHadronPID lists published by DPG
+    if(!RunNumberInListOfGoodRuns()) base = kFALSE;
+    // if pass3: at least two tracks associated with the vertex, distance from the IP lower than cut_fVertexZ
+    // (pass1: these selections were applied on the GRID)
+    if(isPass3 && (fVertexContrib < cut_fVertexContrib || fVertexZ > cut_fVertexZ)) base = kFALSE;
+    if(base) bits |= 1u << 0;
+
+    // 1) !0VBA (no signal in the V0A) and !0VBC (no signal in the V0C)
+    if(!(fTriggerInputsMC[0] || fTriggerInputsMC[1])) bits |= 1u << 1;
+    // 2) !0UBA (no signal in the ADA) and !0UBC (no signal in the ADC)
+    if(!(fTriggerInputsMC[2] || fTriggerInputsMC[3])) bits |= 1u << 2;
+    // 3) 0STG (SPD topological)
+    if(fTriggerInputsMC[10]) bits |= 1u << 3;
+    // 4) 0OMU (TOF two hits topology)
+    if(fTriggerInputsMC[4]) bits |= 1u << 4;
     // 5) AD offline veto (negligible effect on MC)
-    if(cuts[5]){
-        if(!(fADA_dec == 0 && fADC_dec == 0)) return kFALSE;
-    }
-
+    if(fADA_dec == 0 && fADC_dec == 0) bits |= 1u << 5;
     // 6) V0 offline veto (negligible effect on MC)
-    if(cuts[6]){
-        if(!(fV0A_dec == 0 && fV0C_dec == 0)) return kFALSE;
-    }
-
+    if(fV0A_dec == 0 && fV0C_dec == 0) bits |= 1u << 6;
     // 7) SPD cluster matches FOhits
-    if(cuts[7]){
-        if(!(fMatchingSPD == kTRUE)) return kFALSE;
-    }
-
+    if(fMatchingSPD == kTRUE) bits |= 1u << 7;
     // 8) muon pairs only
-    if(cuts[8]){
-        if(!(fTrk1SigIfMu*fTrk1SigIfMu + fTrk2SigIfMu*fTrk2SigIfMu < fTrk1SigIfEl*fTrk1SigIfEl + fTrk2SigIfEl*fTrk2SigIfEl)) return kFALSE;
-    }
-
+    if(fTrk1SigIfMu*fTrk1SigIfMu + fTrk2SigIfMu*fTrk2SigIfMu < fTrk1SigIfEl*fTrk1SigIfEl + fTrk2SigIfEl*fTrk2SigIfEl) bits |= 1u << 8;
     // 9) dilepton rapidity |y| < cut_fY
-    if(cuts[9]){
-        if(!(abs(fY) < cut_fY)) return kFALSE;
-    }
-
+    if(abs(fY) < cut_fY) bits |= 1u << 9;
     // 10) pseudorapidity of both tracks |eta| < cut_fEta
-    if(cuts[10]){
-        if(!(abs(fEta1) < cut_fEta && abs(fEta2) < cut_fEta)) return kFALSE;
-    }
-
+    if(abs(fEta1) < cut_fEta && abs(fEta2) < cut_fEta) bits |= 1u << 10;
     // 11) tracks have opposite charges
-    if(cuts[11]){
-        if(!(fQ1 * fQ2 < 0)) return kFALSE;
-    }
-
+    if(fQ1 * fQ2 < 0) bits |= 1u << 11;
     // 12) invariant mass between 2.2 and 4.5 GeV/c^2
-    if(cuts[12]){
-        Bool_t bMassCut = kFALSE;
-        switch(iMassCut){
-            case -1: // No inv mass cut
-                bMassCut = kTRUE;
-                break;
-            case 0:
-                if(fM > 2.2 && fM < 4.5) bMassCut = kTRUE;
-                break;
-            case 1:
-                if(fM > 3.0 && fM < 3.2) bMassCut = kTRUE;
-                break;
+    if(fM > 2.2 && fM < 4.5) bits |= 1u << 12;
+
+    return bits;
+}
+
+// name of the configuration (as ConvertCutsToString) from the mask of cuts 1..12
+TString CutFlowConfig(Bool_t ptGen, UInt_t mask)
+{
+    TString s("cuts_");
+    s.Append(ptGen ? "1" : "0");
+    for(Int_t iCut = 1; iCut < nCuts; iCut++) s.Append((mask & (1u << iCut)) ? "1" : "0");
+    return s;
+}
+
+// all configurations used in AxE_PtDep: only the pt cut, each cut alone and cuts 1 to i (vs pt rec and pt gen),
+// 0STG + 0OMU + SPD matching (vs pt rec)
+std::vector<TString> CutFlowConfigs()
+{
+    std::vector<TString> configs;
+    for(Int_t ptGen = 0; ptGen <= 1; ptGen++)
+    {
+        configs.push_back(CutFlowConfig(ptGen, 0));
+        UInt_t prefix = 0;
+        for(Int_t iCut = 1; iCut < nCuts; iCut++)
+        {
+            prefix |= 1u << iCut;
+            configs.push_back(CutFlowConfig(ptGen, 1u << iCut));
+            if(iCut > 1) configs.push_back(CutFlowConfig(ptGen, prefix));
         }
-        if(!bMassCut) return kFALSE;
     }
+    configs.push_back(CutFlowConfig(kFALSE, (1u << 3) | (1u << 4) | (1u << 7)));
+    return configs;
+}
 
-    // Event passed all the selections =>
-    return kTRUE;
+// fill N rec per bin for all configurations that have not been calculated yet, in one pass over the MC
+void FillHistNRec_CutFlow(std::vector<TString> configs)
+{
+    nBins = sizeof(edges) / sizeof(edges[0]) - 1;
+    std::vector<TString> files;
+    std::vector<UInt_t> masks;
+    std::vector<Bool_t> vsPtGen;
+    std::vector<TH1F*> hists;
+    for(UInt_t i = 0; i < configs.size(); i++)
+    {
+        TString file = "Results/" + str_subfolder + "AxE_PtDep/" + configs[i] + ".txt";
+        if(!gSystem->AccessPathName(file.Data())) continue;
+        if(std::find(files.begin(), files.end(), file) != files.end()) continue;
+        UInt_t mask = 1u << 0;
+        for(Int_t iCut = 1; iCut < nCuts; iCut++) if(configs[i][5+iCut] == '1') mask |= 1u << iCut;
+        files.push_back(file);
+        masks.push_back(mask);
+        vsPtGen.push_back(configs[i][5] == '1');
+        hists.push_back(new TH1F(Form("hRec_%s", configs[i].Data()),"N rec per bin",nBins,edges));
+    }
+    if(files.size() == 0) return;
+    Printf("*** Calculating N_rec per bin for %i configurations of cuts... ***", (Int_t)files.size());
+
+    TFile *fRec = TFile::Open((str_in_MC_fldr_rec + "AnalysisResults_MC_kIncohJpsiToMu.root").Data(), "read");
+    if(fRec) Printf("MC rec file loaded.");
+    TTree *tRec = dynamic_cast<TTree*> (fRec->Get(str_in_MC_tree_rec.Data()));
+    if(tRec) Printf("MC rec tree loaded.");
+    ConnectTreeVariablesMCRec(tRec);
+
+    // load the ratio to re-weight the spectra
+    TH1F* hRatios = GetRatioHisto();
+    ReweightTable weights(hRatios);
+    // loop over tree entries
+    for(Int_t iEntry = 0; iEntry < tRec->GetEntries(); iEntry++) {
+        tRec->GetEntry(iEntry);
+        UInt_t bits = CutFlowBits();
+        if(!(bits & 1u)) continue;
+        Float_t weight = weights.Weight(fPtGen);
+        for(UInt_t i = 0; i < files.size(); i++) {
+            if((bits & masks[i]) != masks[i]) continue;
+            if(vsPtGen[i]) hists[i]->Fill(fPtGen, weight);
+            else           hists[i]->Fill(fPt, weight);
+        }
+    }
+    Printf("*** Finished! ***");
+    for(UInt_t i = 0; i < files.size(); i++) {
+        SaveToFile(files[i],hists[i]);
+        delete hists[i];
+    }
+    fRec->Close();
+    return;
 }
 
 void SetPad(TPad* p)
@@ -15,6 +15,8 @@
 #include "TString.h"
 #include "TStyle.h"
 #include "TMath.h"
+// my headers
+#include "ReweightTable.h"
 
 TH1F* hRec = NULL; 
 TH1F* hGen = NULL; 
@@ -141,12 +143,11 @@ TH1F* GetRatioHisto()
     return h;
 }
 
-void AxE_PtBins_FillHistNRec(Bool_t reWeight, Float_t fCutZ)
+// (variations of the cut on vertex Z are scanned by VertexZ_SystUncertainties.C)
+void AxE_PtBins_FillHistNRec(Bool_t reWeight)
 {
     // check if the corresponding text file already exists
-    TString sOut;
-    if(fCutZ == cut_fVertexZ) sOut = "Results/" + str_subfolder + "AxE_PtBins/";
-    else                      sOut = "Results/" + str_subfolder + Form("VertexZ_SystUncertainties/Zcut%.1f_AxE_PtBins/", fCutZ);
+    TString sOut = "Results/" + str_subfolder + "AxE_PtBins/";
     if(reWeight) sOut += "reweighted_";
     sOut.Append(Form("NRec_%ibins.txt", nPtBins));
 
@@ -178,27 +179,15 @@ void AxE_PtBins_FillHistNRec(Bool_t reWeight, Float_t fCutZ)
         if(tRec) Printf("MC rec tree loaded.");
         ConnectTreeVariablesMCRec(tRec);
 
-        // |> *********** for VertexZ_SystUncertainties.C ***********
-        // save the original value of cut_fVertexZ
-        Printf("Original cut on vertex Z: %.1f", cut_fVertexZ);
-        Float_t fCutZ_orig = cut_fVertexZ;
-        if(fCutZ != cut_fVertexZ) {
-            // set the new value of cut_fVertexZ
-            cut_fVertexZ = fCutZ;
-            Printf("New cut on vertex Z: %.1f", cut_fVertexZ);
-        }
-        // <| *****************************************************
-
         // load the ratio to re-weight the spectra
         TH1F* hRatios = GetRatioHisto();
-        TAxis* xAxis = hRatios->GetXaxis();
+        ReweightTable weights(hRatios);
         // go over tree entries and calculate NRec in the total range and in bins
         Float_t NRec_tot(0.);
         for(Int_t iEntry = 0; iEntry < tRec->GetEntries(); iEntry++) {
             tRec->GetEntry(iEntry);
-            Int_t iBinGen = xAxis->FindBin(fPtGen);
             Float_t weight = 1.0; 
-            if(reWeight) weight = hRatios->GetBinContent(iBinGen);
+            if(reWeight) weight = weights.Weight(fPtGen);
             // m between 2.2 and 4.5 GeV/c^2
             // & pT from 0.2 to 1.0 GeV/c
             if(EventPassedMCRec(0, 3)) {
@@ -207,15 +196,6 @@ void AxE_PtBins_FillHistNRec(Bool_t reWeight, Float_t fCutZ)
             }
         }
         Printf("*** Finished! ***");
-
-        // |> *********** for VertexZ_SystUncertainties.C ***********
-        if(cut_fVertexZ != fCutZ_orig)
-        {
-            // set back the original value of cut_fVertexZ
-            cut_fVertexZ = fCutZ_orig;
-            Printf("Restoring the original cut on vertex Z: %.1f", cut_fVertexZ);  
-        }
-        // <| *****************************************************
         
         NRec_tot_val = NRec_tot;
         NRec_tot_err = TMath::Sqrt(NRec_tot);
@@ -261,14 +241,13 @@ void AxE_PtBins_FillHistNGen(Bool_t reWeight)
 
         // load the ratio to re-weight the spectra
         TH1F* hRatios = GetRatioHisto();
-        TAxis* xAxis = hRatios->GetXaxis();
+        ReweightTable weights(hRatios);
         // go over tree entries and calculate NRec in the total range and in bins
         Float_t NGen_tot(0.);
         for(Int_t iEntry = 0; iEntry < tGen->GetEntries(); iEntry++) {
             tGen->GetEntry(iEntry);
-            Int_t iBinGen = xAxis->FindBin(fPtGen);
             Float_t weight = 1.0; 
-            if(reWeight) weight = hRatios->GetBinContent(iBinGen);
+            if(reWeight) weight = weights.Weight(fPtGen);
             // m between 2.2 and 4.5 GeV/c^2
             // & pT from 0.2 to 1.0 GeV/c
             if(EventPassedMCGen(3)) {
@@ -286,12 +265,12 @@ void AxE_PtBins_FillHistNGen(Bool_t reWeight)
     return;
 }
 
-void AxE_PtBins_Calculate(Bool_t reWeight, Float_t fCutZ)
+void AxE_PtBins_Calculate(Bool_t reWeight)
 {
     hRec = new TH1F("hRec","N_{rec} per bin",nPtBins,ptBoundaries);
     hGen = new TH1F("hGen","N_{gen} per bin",nPtBins,ptBoundaries);
 
-    AxE_PtBins_FillHistNRec(reWeight,fCutZ);
+    AxE_PtBins_FillHistNRec(reWeight);
     AxE_PtBins_FillHistNGen(reWeight);
 
     hAxE = (TH1F*)hRec->Clone("hAxE");
@@ -303,9 +282,7 @@ void AxE_PtBins_Calculate(Bool_t reWeight, Float_t fCutZ)
     hAxE->GetYaxis()->SetRangeUser(0.015,0.035);
     TLegend *l = CreateLegendAxE();
     // save the figures and print the results to txt file
-    TString folder(""), name("");
-    if(fCutZ == cut_fVertexZ) folder = "AxE_PtBins/";
-    else                      folder = Form("VertexZ_SystUncertainties/Zcut%.1f_AxE_PtBins/",fCutZ);
+    TString folder("AxE_PtBins/"), name("");
     if(reWeight) name += "reweighted_";
     name += Form("AxE_%ibins",nPtBins);
     if(tw) PlotHistos("_rozprava/",name,"E0",kFALSE,0.8,hAxE,NULL,l);
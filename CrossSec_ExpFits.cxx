@@ -1,22 +1,188 @@
 // CrossSec_ExpFits.C
 // David Grund, Sep 04, 2022
+// root -l -b -q 'CrossSec_ExpFits.cxx+(3)'
+// Fits of the binned data and models by a exp(-bt) and a exp(-bt + ct^2)
+// All fits of all models and the data are done at once by ExpFit_FitAll():
+//  - weights: full covariance of the data (uncorrelated + correlated uncertainties), the same for the models
+//  - log_line: generalized least squares of log(sigma), solved in closed form
+//  - exp_pure, exp_quad: Gauss-Newton with analytic Jacobians, started from the closed-form fit of log(sigma)
+//  - parameter covariance from the Hessian; for the models (no uncertainties of their own) it is scaled
+//    by chi2/ndf, as TGraph::Fit does for graphs without errors
 
+// root headers
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TVectorD.h"
 // my headers
 #include "CrossSec_Utilities.h"
 
 TGraphErrors *gr_data = NULL;
-TGraph *gr_binned[7] = { NULL };
+TGraph *gr_binned[9] = { NULL };
 Double_t par_val[3];
 Double_t par_err[3];
 
+// results of all fits: series (0-8 models, 9 data) x forms, parameters (a, b, c) and their covariance
+const Int_t ExpFit_nSeries = 10;
+const Int_t ExpFit_iData = 9;
+const Int_t ExpFit_nForms = 3;
+TString ExpFit_strForms[ExpFit_nForms] = {"log_line", "exp_pure", "exp_quad"};
+Int_t ExpFit_nPar[ExpFit_nForms] = {2, 2, 3};
+Double_t ExpFit_par[ExpFit_nSeries][ExpFit_nForms][3] = { 0 };
+Double_t ExpFit_cov[ExpFit_nSeries][ExpFit_nForms][3][3] = { 0 };
+Double_t ExpFit_chi2[ExpFit_nSeries][ExpFit_nForms] = { 0 };
+Bool_t ExpFit_converged[ExpFit_nSeries][ExpFit_nForms] = { 0 };
+
 void DoExpFit(Int_t iM, TString fit);
 // iM ... index of a model
-// iM = 0 ... 6 => models, == 7 => data
+// iM = 0 ... 8 => models, == 9 => data
 // fit = exp_pure => pure exponential
 //     = exp_quad => exponential with a quadratic term
 //     = log_line => fitting log points with a straight line
 
-void CrossSec_ExpFits(Int_t iAnalysis)
+// generalized least squares z = A theta with the weight matrix W (closed form)
+void ExpFit_GLS(const TMatrixD &A, const TVectorD &z, const TMatrixD &W, TVectorD &theta, TMatrixD &cov)
+{
+    TMatrixD AtW(A, TMatrixD::kTransposeMult, W);
+    cov.ResizeTo(A.GetNcols(), A.GetNcols());
+    cov = AtW * A;
+    cov.Invert();
+    theta.ResizeTo(A.GetNcols());
+    theta = cov * (AtW * z);
+
+    return;
+}
+
+// a exp(-bt + ct^2) and its derivatives with respect to a, b (and c)
+Double_t ExpFit_Eval(Int_t nPar, const Double_t *p, Double_t x, Double_t *dfdp)
+{
+    Double_t e = TMath::Exp(-p[1] * x + (nPar > 2 ? p[2] * x * x : 0.));
+    Double_t f = p[0] * e;
+    dfdp[0] = e;
+    dfdp[1] = -x * f;
+    if(nPar > 2) dfdp[2] = x * x * f;
+
+    return f;
+}
+
+Double_t ExpFit_Chi2(Int_t nPar, const Double_t *p, const Double_t *x, const Double_t *y, const TMatrixD &W)
+{
+    Double_t dfdp[3];
+    TVectorD r(nPtBins);
+    for(Int_t i = 0; i < nPtBins; i++) r(i) = y[i] - ExpFit_Eval(nPar, p, x[i], dfdp);
+
+    return r * (W * r);
+}
+
+// fits of one series (x, y) by all forms
+void ExpFit_FitSeries(Int_t iS, const Double_t *x, const Double_t *y, const TMatrixD &W, const TMatrixD &W_log)
+{
+    TVectorD z(nPtBins);
+    for(Int_t i = 0; i < nPtBins; i++) z(i) = TMath::Log(y[i]);
+    for(Int_t iF = 0; iF < ExpFit_nForms; iF++)
+    {
+        Int_t nPar = ExpFit_nPar[iF];
+        // closed-form fit of log(sigma) = log(a) - bt (+ ct^2)
+        TMatrixD A(nPtBins, nPar);
+        for(Int_t i = 0; i < nPtBins; i++) {
+            A(i,0) = 1.;
+            A(i,1) = -x[i];
+            if(nPar > 2) A(i,2) = x[i] * x[i];
+        }
+        TVectorD theta;
+        TMatrixD cov_theta;
+        ExpFit_GLS(A, z, W_log, theta, cov_theta);
+        Double_t p[3] = {TMath::Exp(theta(0)), theta(1), nPar > 2 ? theta(2) : 0.};
+        TMatrixD cov(nPar, nPar);
+        Double_t chi2 = 0.;
+        Bool_t converged = kTRUE;
+        if(ExpFit_strForms[iF] == "log_line")
+        {
+            // a = exp(theta_0) => d a = a d theta_0
+            TMatrixD D(nPar, nPar);
+            D(0,0) = p[0];
+            for(Int_t k = 1; k < nPar; k++) D(k,k) = 1.;
+            cov = D * TMatrixD(cov_theta, TMatrixD::kMultTranspose, D);
+            TVectorD r = z - A * theta;
+            chi2 = r * (W_log * r);
+        }
+        else
+        {
+            // Gauss-Newton with step halving
+            chi2 = ExpFit_Chi2(nPar, p, x, y, W);
+            converged = kFALSE;
+            for(Int_t iIter = 0; iIter < 100 && !converged; iIter++)
+            {
+                TMatrixD J(nPtBins, nPar);
+                TVectorD r(nPtBins);
+                for(Int_t i = 0; i < nPtBins; i++) {
+                    Double_t dfdp[3];
+                    r(i) = y[i] - ExpFit_Eval(nPar, p, x[i], dfdp);
+                    for(Int_t k = 0; k < nPar; k++) J(i,k) = dfdp[k];
+                }
+                TVectorD delta;
+                TMatrixD H_inv;
+                ExpFit_GLS(J, r, W, delta, H_inv);
+                Double_t step = 1.;
+                Double_t p_new[3] = { 0 };
+                Double_t chi2_new = chi2;
+                for(Int_t iHalf = 0; iHalf < 30; iHalf++, step /= 2.) {
+                    for(Int_t k = 0; k < 3; k++) p_new[k] = p[k] + (k < nPar ? step * delta(k) : 0.);
+                    chi2_new = ExpFit_Chi2(nPar, p_new, x, y, W);
+                    if(chi2_new <= chi2) break;
+                }
+                if(chi2_new > chi2) { converged = kTRUE; break; } // no decrease possible: at the minimum
+                converged = (chi2 - chi2_new < 1e-10 * (1. + chi2));
+                for(Int_t k = 0; k < nPar; k++) p[k] = p_new[k];
+                chi2 = chi2_new;
+            }
+            // covariance of the parameters from the Hessian at the minimum
+            TMatrixD J(nPtBins, nPar);
+            for(Int_t i = 0; i < nPtBins; i++) {
+                Double_t dfdp[3];
+                ExpFit_Eval(nPar, p, x[i], dfdp);
+                for(Int_t k = 0; k < nPar; k++) J(i,k) = dfdp[k];
+            }
+            cov = TMatrixD(J, TMatrixD::kTransposeMult, W) * J;
+            cov.Invert();
+        }
+        // models: scale by chi2/ndf
+        Int_t ndf = nPtBins - nPar;
+        if(iS != ExpFit_iData && ndf > 0) cov *= chi2 / ndf;
+        for(Int_t k = 0; k < 3; k++) {
+            ExpFit_par[iS][iF][k] = p[k];
+            for(Int_t l = 0; l < 3; l++) ExpFit_cov[iS][iF][k][l] = (k < nPar && l < nPar) ? cov(k,l) : 0.;
+        }
+        ExpFit_chi2[iS][iF] = chi2;
+        ExpFit_converged[iS][iF] = converged;
+        if(!converged) Printf("Warning: fit %s of the series %i did not converge.", ExpFit_strForms[iF].Data(), iS);
+    }
+
+    return;
+}
+
+// all fits of all series
+void ExpFit_FitAll()
+{
+    // covariance of the data (and of log(data) through the relative uncertainties)
+    TMatrixDSym V(nPtBins), V_log(nPtBins);
+    for(Int_t i = 0; i < nPtBins; i++) for(Int_t j = 0; j < nPtBins; j++) {
+        V(i,j) = gr_data_corr->GetErrorYhigh(i) * gr_data_corr->GetErrorYhigh(j);
+        if(i == j) V(i,j) += TMath::Power(gr_data_uncr->GetErrorYhigh(i), 2);
+        V_log(i,j) = V(i,j) / (gr_data_uncr->GetPointY(i) * gr_data_uncr->GetPointY(j));
+    }
+    TMatrixD W(V), W_log(V_log);
+    W.Invert();
+    W_log.Invert();
+    for(Int_t iS = 0; iS < ExpFit_nSeries; iS++)
+    {
+        TGraph *gr = (iS == ExpFit_iData) ? (TGraph*)gr_data : gr_binned[iS];
+        ExpFit_FitSeries(iS, gr->GetX(), gr->GetY(), W, W_log);
+    }
+
+    return;
+}
+
+void CrossSec_ExpFits(Int_t iAnalysis, Bool_t plot = kTRUE)
 {
     InitAnalysis(iAnalysis);
 
@@ -45,52 +211,61 @@ void CrossSec_ExpFits(Int_t iAnalysis)
         gr_data->SetPointError(i,0.,gr_data_uncr->GetErrorY(i));
     }
 
-    // do the fits and print the results
+    // do all the fits
+    ExpFit_FitAll();
+
+    // print the results
     ofstream os;
     os.open("Results/" + str_subfolder + "CrossSec/ExpFits/#parameters.txt");
     os << std::fixed << std::setprecision(2)
        << "model\t\ta [mub GeV^2] \tb [GeV^2]\n";
-    // fit data
-    if(true) {
-        os << "data/model\t"; 
-        DoExpFit(7,"log_line");
-        os << par_val[0] * 1e3 << "\t" << par_err[0] * 1e3 << "\t"
-           << par_val[1] << "\t" << par_err[1] << "\n";
-        DoExpFit(7,"exp_pure");
-        DoExpFit(7,"exp_quad");
+    for(Int_t i = 0; i < ExpFit_nSeries; i++)
+    {
+        Int_t iS = (i == 0) ? ExpFit_iData : i-1; // data first
+        if(iS == ExpFit_iData) os << "data/model\t";
+        else {
+            os << Form("%s\t", str_models[iS].Data());
+            if(str_models[iS].Length() < 8) os << "\t";
+        }
+        os << ExpFit_par[iS][0][0] * 1e3 << "\t" << TMath::Sqrt(ExpFit_cov[iS][0][0][0]) * 1e3 << "\t"
+           << ExpFit_par[iS][0][1] << "\t" << TMath::Sqrt(ExpFit_cov[iS][0][1][1]) << "\n";
     }
-    // models
-    if(true) {
-        for(Int_t i = 0; i < 7; i++) {
-            os << Form("%s\t", str_models[i].Data());
-            if(i != 0 && i != 5) os << "\t";
-            DoExpFit(i,"log_line");
-            os << par_val[0] * 1e3 << "\t" << par_err[0] * 1e3 << "\t"
-               << par_val[1] << "\t" << par_err[1] << "\n";
-            DoExpFit(i,"exp_pure");
-            DoExpFit(i,"exp_quad");
-        } 
+    os.close();
+    // all forms with the correlations of the parameters
+    os.open("Results/" + str_subfolder + "CrossSec/ExpFits/all_fits.txt");
+    os << std::fixed << std::setprecision(4)
+       << "series\tform\ta [mub GeV^-2]\terr\tb [GeV^-2]\terr\tc [GeV^-4]\terr\tcorr(a,b)\tcorr(b,c)\tchi2\tndf\n";
+    for(Int_t iS = 0; iS < ExpFit_nSeries; iS++) for(Int_t iF = 0; iF < ExpFit_nForms; iF++)
+    {
+        Double_t (*C)[3] = ExpFit_cov[iS][iF];
+        Double_t err[3];
+        for(Int_t k = 0; k < 3; k++) err[k] = TMath::Sqrt(C[k][k]);
+        os << (iS == ExpFit_iData ? TString("data") : str_models[iS]) << "\t" << ExpFit_strForms[iF] << "\t"
+           << ExpFit_par[iS][iF][0] * 1e3 << "\t" << err[0] * 1e3 << "\t"
+           << ExpFit_par[iS][iF][1] << "\t" << err[1] << "\t"
+           << ExpFit_par[iS][iF][2] << "\t" << err[2] << "\t"
+           << C[0][1] / (err[0] * err[1]) << "\t" << (err[2] > 0 ? C[1][2] / (err[1] * err[2]) : 0.) << "\t"
+           << ExpFit_chi2[iS][iF] << "\t" << nPtBins - ExpFit_nPar[iF] << "\n";
     }
     os.close();
+
+    // plot the fits
+    if(plot) {
+        for(Int_t iS = 0; iS < ExpFit_nSeries; iS++) 
+            for(Int_t iF = 0; iF < ExpFit_nForms; iF++) DoExpFit(iS, ExpFit_strForms[iF]);
+    }
     return;
 }
 
 void DoExpFit(Int_t iM, TString fit)
 {
     TGraph *gr = NULL;
-    TGraph *gr_log = new TGraph(nPtBins);
-    if(iM == 7) {
-        gr = gr_data;
-        for(Int_t i = 0; i < nPtBins; i++) gr_log->SetPoint(i,gr_data->GetPointX(i),TMath::Log(gr_data->GetPointY(i)));
-    } else {
-        gr = gr_binned[iM];
-        for(Int_t i = 0; i < nPtBins; i++) gr_log->SetPoint(i,gr_binned[iM]->GetPointX(i),TMath::Log(gr_binned[iM]->GetPointY(i)));
-    }
+    if(iM == ExpFit_iData) gr = gr_data;
+    else                   gr = gr_binned[iM];
 
     TF1 *f = NULL;
     TF1 *f_exp_pure = new TF1("f_exp_pure", "[0] * exp(-[1] * x)", 0.04, 1.0);
     TF1 *f_exp_quad = new TF1("f_exp_quad", "[0] * exp(-[1] * x + [2] * x * x)", 0.04, 1.0);
-    TF1 *f_log = new TF1("f_log", "[0] - x * [1]", 0.04, 1.0);
     if(fit == "exp_pure" || fit == "log_line") {
         f = f_exp_pure;
         f->SetLineColor(kRed);
@@ -101,20 +276,14 @@ void DoExpFit(Int_t iM, TString fit)
     f->SetLineStyle(9);
     f->SetLineWidth(2);
     
-    // https://root.cern.ch/doc/master/classTH1.html#HFitRange
-    if(fit != "log_line") gr->Fit(f, "R");
-    else {
-        gr_log->Fit(f_log, "R");
-        f->SetParameter(0, TMath::Exp(f_log->GetParameter(0)));
-        f->SetParameter(1, f_log->GetParameter(1));
-    }
-    int npar = 0;
-    if(fit == "exp_pure") npar = 2;
-    else if(fit == "exp_quad") npar = 3;
-    else if(fit == "log_line") npar = 2;
+    // parameters from ExpFit_FitAll()
+    Int_t iF = 0;
+    while(ExpFit_strForms[iF] != fit) iF++;
+    int npar = ExpFit_nPar[iF];
     for(Int_t ipar = 0; ipar < npar; ipar++) {
-        par_val[ipar] = f->GetParameter(ipar);
-        par_err[ipar] = f->GetParError(ipar);
+        par_val[ipar] = ExpFit_par[iM][iF][ipar];
+        par_err[ipar] = TMath::Sqrt(ExpFit_cov[iM][iF][ipar][ipar]);
+        f->SetParameter(ipar, par_val[ipar]);
     }
     // set data properties 
     gStyle->SetEndErrorSize(4);         
@@ -153,7 +322,7 @@ void DoExpFit(Int_t iM, TString fit)
     f->Draw("L SAME");
 
     TString name;
-    if(iM == 7) name = "ALICE measurement";
+    if(iM == ExpFit_iData) name = "ALICE measurement";
     else        name = str_models[iM];
 
     TLegend *l = new TLegend(0.48,0.70,0.95,0.96);
@@ -181,13 +350,10 @@ void DoExpFit(Int_t iM, TString fit)
     l->SetMargin(0.16);
     l->Draw();
     
-    if(iM == 7) cFit->Print("Results/" + str_subfolder + "CrossSec/ExpFits/" + fit + "/" + name + ".pdf");
-    else cFit->Print("Results/" + str_subfolder + "CrossSec/ExpFits/" + fit + "/" + name + ".pdf");
+    cFit->Print("Results/" + str_subfolder + "CrossSec/ExpFits/" + fit + "/" + name + ".pdf");
 
     delete cFit;
-    delete gr_log;
     delete f_exp_pure;
     delete f_exp_quad;
-    delete f_log;
     return;
 }
\ No newline at end of file
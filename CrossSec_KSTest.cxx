@@ -1,12 +1,34 @@
 // CrossSec_KSTest.C
 // David Grund, Aug 28, 2023
+// root -l -b -q 'CrossSec_KSTest.cxx+(3,100000,4)'
+// DoKSTest: plots of the cumulative distributions of the data and the models (nominal values)
+// KSTest_Compatibility: p-values of the chi2, KS and likelihood-ratio statistics of all models,
+// from pseudo-measurements generated with the full (stat + syst) covariance of the data
 
+// cpp headers
+#include <thread>
+// root headers
+#include "TRandom3.h"
+#include "TMatrixDSym.h"
+#include "TDecompChol.h"
 // my headers
 #include "CrossSec_Utilities.h"
+#include "StageCache.h"
 
 TH1F* hBinned_data = NULL;
 TH1F* hBinned_models[9] = { NULL };
 
+// statistics of the compatibility tests
+const int KSTest_nStat = 3;
+TString KSTest_strStat[KSTest_nStat] = {"chi2", "KS", "LR"};
+const int KSTest_blockSize = 1000; // toys generated from one seed (results do not depend on the number of threads)
+double KSTest_mu[9][5] = { 0 };    // model bin integrals (mb)
+double KSTest_data[5] = { 0 };     // data bin integrals (mb)
+double KSTest_U[5][5] = { 0 };     // covariance of the data bin integrals: V = U^T U
+double KSTest_Vinv[5][5] = { 0 };  // its inverse
+double KSTest_obs[9][KSTest_nStat] = { 0 }; // observed values of the statistics
+double KSTest_norm[9] = { 0 };     // fitted normalization of each model (LR)
+
 void DoKSTest (int iModel)
 {
     TGraph *gr_data = new TGraph();
@@ -98,7 +120,187 @@ void DoKSTest (int iModel)
     return;
 }
 
-void CrossSec_KSTest(int iAnalysis)
+// integrals of the models over the |t| bins, cached between the runs
+// (recalculated only if the model tables, the binning or the interpolation changed)
+bool KSTest_LoadModelIntegrals()
+{
+    TString name = "Trees/" + str_subfolder + "CrossSec_KSTest/model_integrals.txt";
+    std::vector<TString> inputs;
+    for(int i = 0; i < ModelStore_nTables; i++) inputs.push_back(ModelStore_tables[i]);
+    inputs.push_back("ModelStore.h");
+    inputs.push_back("CrossSec_KSTest.cxx");
+    TString config = Form("interp=%i;bins", ModelStore_interp);
+    for(int i = 0; i <= nPtBins; i++) config += Form(";%.6f", tBoundaries[i]);
+    TString key = StageCache_Key("CrossSec_KSTest_models", 1, inputs, config);
+    if(StageCache_IsUpToDate(name, key))
+    {
+        ifstream ifs(name.Data());
+        for(int iM = 0; iM < 9; iM++) for(int iBin = 0; iBin < nPtBins; iBin++) ifs >> KSTest_mu[iM][iBin];
+        bool ok = !ifs.fail();
+        ifs.close();
+        if(ok) { Printf("Model bin integrals loaded from %s.", name.Data()); return true; }
+    }
+    if(!ModelStore_Load()) return false;
+    std::vector<Double_t> avg[ModelStore_nModels], avg_t[ModelStore_nModels];
+    ModelStore_BinAverages(nPtBins, tBoundaries, avg, avg_t);
+    gSystem->Exec("mkdir -p Trees/" + str_subfolder + "CrossSec_KSTest/");
+    ofstream of(name.Data());
+    of << std::setprecision(12);
+    for(int iM = 0; iM < 9; iM++) {
+        for(int iBin = 0; iBin < nPtBins; iBin++) {
+            KSTest_mu[iM][iBin] = avg[iM][iBin] * (tBoundaries[iBin+1] - tBoundaries[iBin]);
+            of << KSTest_mu[iM][iBin] << "\t";
+        }
+        of << "\n";
+    }
+    of.close();
+    StageCache_Update(name, key, "CrossSec_KSTest model bin integrals");
+
+    return true;
+}
+
+// covariance of the data bin integrals: uncorrelated (stat + syst uncr) and fully correlated (syst corr) parts
+bool KSTest_SetCovariance()
+{
+    TMatrixDSym V(nPtBins);
+    for(int i = 0; i < nPtBins; i++) {
+        double w_i = tBoundaries[i+1] - tBoundaries[i];
+        KSTest_data[i] = gr_data_uncr->GetPointY(i) * w_i;
+        for(int j = 0; j < nPtBins; j++) {
+            double w_j = tBoundaries[j+1] - tBoundaries[j];
+            V(i,j) = gr_data_corr->GetErrorYhigh(i) * gr_data_corr->GetErrorYhigh(j) * w_i * w_j;
+            if(i == j) V(i,j) += TMath::Power(gr_data_uncr->GetErrorYhigh(i) * w_i, 2);
+        }
+    }
+    TDecompChol chol(V);
+    if(!chol.Decompose()) { Printf("Covariance of the data not positive definite."); return false; }
+    TMatrixD U = chol.GetU();
+    TMatrixDSym Vinv(V);
+    Vinv.Invert();
+    for(int i = 0; i < nPtBins; i++) for(int j = 0; j < nPtBins; j++) {
+        KSTest_U[i][j] = U(i,j);
+        KSTest_Vinv[i][j] = Vinv(i,j);
+    }
+
+    return true;
+}
+
+double KSTest_Chi2(const double *d, const double *mu)
+{
+    double chi2 = 0.;
+    for(int i = 0; i < nPtBins; i++) for(int j = 0; j < nPtBins; j++) chi2 += (d[i] - mu[i]) * KSTest_Vinv[i][j] * (d[j] - mu[j]);
+    return chi2;
+}
+
+// statistics of the measurement d with respect to the model mu:
+// chi2: full chi2 (shape and normalization)
+// KS:   maximum distance of the normalized cumulative distributions (shape)
+// LR:   -2 ln of the likelihood ratio of the model with a free normalization and the saturated model
+//       (the Gaussian likelihood => chi2 at the best normalization a = mu^T V^-1 d / mu^T V^-1 mu)
+void KSTest_Statistics(const double *d, const double *mu, double *stat, double &a)
+{
+    stat[0] = KSTest_Chi2(d, mu);
+    double sum_d(0.), sum_mu(0.), cum_d(0.), cum_mu(0.), ks(0.);
+    for(int i = 0; i < nPtBins; i++) { sum_d += d[i]; sum_mu += mu[i]; }
+    if(sum_d > 0.) {
+        for(int i = 0; i < nPtBins; i++) {
+            cum_d += d[i];
+            cum_mu += mu[i];
+            ks = TMath::Max(ks, TMath::Abs(cum_d / sum_d - cum_mu / sum_mu));
+        }
+    } else ks = 1.;
+    stat[1] = ks;
+    double num(0.), den(0.);
+    for(int i = 0; i < nPtBins; i++) for(int j = 0; j < nPtBins; j++) {
+        num += mu[i] * KSTest_Vinv[i][j] * d[j];
+        den += mu[i] * KSTest_Vinv[i][j] * mu[j];
+    }
+    a = num / den;
+    double mu_a[5] = { 0 };
+    for(int i = 0; i < nPtBins; i++) mu_a[i] = a * mu[i];
+    stat[2] = KSTest_Chi2(d, mu_a);
+
+    return;
+}
+
+// toys of the blocks firstBlock..lastBlock-1: pseudo-measurements around each model (chi2) and around
+// the model with the fitted normalization (KS, LR), all with the same fluctuations z
+void KSTest_Worker(int seed, int firstBlock, int lastBlock, int nToys, Long64_t (*nExceed)[KSTest_nStat])
+{
+    for(int iBlock = firstBlock; iBlock < lastBlock; iBlock++)
+    {
+        // (+1: TRandom3(0) would be seeded from the time)
+        TRandom3 rnd(seed * 1000003 + iBlock + 1);
+        int nInBlock = TMath::Min(KSTest_blockSize, nToys - iBlock * KSTest_blockSize);
+        for(int iToy = 0; iToy < nInBlock; iToy++)
+        {
+            double z[5] = { 0 }, dz[5] = { 0 };
+            for(int i = 0; i < nPtBins; i++) z[i] = rnd.Gaus();
+            for(int i = 0; i < nPtBins; i++) for(int j = 0; j <= i; j++) dz[i] += KSTest_U[j][i] * z[j];
+            for(int iM = 0; iM < 9; iM++)
+            {
+                double d[5] = { 0 }, stat[KSTest_nStat] = { 0 }, a(0.);
+                for(int i = 0; i < nPtBins; i++) d[i] = KSTest_mu[iM][i] + dz[i];
+                KSTest_Statistics(d, KSTest_mu[iM], stat, a);
+                if(stat[0] >= KSTest_obs[iM][0]) nExceed[iM][0]++;
+                for(int i = 0; i < nPtBins; i++) d[i] = KSTest_norm[iM] * KSTest_mu[iM][i] + dz[i];
+                KSTest_Statistics(d, KSTest_mu[iM], stat, a);
+                for(int iS = 1; iS < KSTest_nStat; iS++) if(stat[iS] >= KSTest_obs[iM][iS]) nExceed[iM][iS]++;
+            }
+        }
+    }
+    return;
+}
+
+void KSTest_Compatibility(int nToys, int nThr, int seed)
+{
+    if(!KSTest_LoadModelIntegrals()) return;
+    if(!KSTest_SetCovariance()) return;
+    for(int iM = 0; iM < 9; iM++) KSTest_Statistics(KSTest_data, KSTest_mu[iM], KSTest_obs[iM], KSTest_norm[iM]);
+
+    // generate the toys in parallel threads
+    if(nThr < 1) nThr = 1;
+    int nBlocks = (nToys + KSTest_blockSize - 1) / KSTest_blockSize;
+    std::vector<std::vector<Long64_t>> counts(nThr, std::vector<Long64_t>(9 * KSTest_nStat, 0));
+    std::vector<std::thread> threads;
+    for(int iThr = 0; iThr < nThr; iThr++) {
+        int firstBlock = nBlocks * iThr / nThr;
+        int lastBlock = nBlocks * (iThr+1) / nThr;
+        threads.push_back(std::thread(KSTest_Worker, seed, firstBlock, lastBlock, nToys, (Long64_t (*)[KSTest_nStat])counts[iThr].data()));
+    }
+    for(UInt_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    // p-values
+    TString str_out = "Results/" + str_subfolder + "CrossSec/KSTest/p_values.txt";
+    ofstream os(str_out.Data());
+    os << std::fixed << std::setprecision(4);
+    os << "model\tnorm";
+    for(int iS = 0; iS < KSTest_nStat; iS++) os << "\t" << KSTest_strStat[iS] << "\tp-value\terr";
+    os << "\n";
+    Printf("%i toys, %i threads:", nToys, nThr);
+    for(int iM = 0; iM < 9; iM++)
+    {
+        os << str_models[iM] << "\t" << KSTest_norm[iM];
+        TString str_print = Form("%-12s norm %.3f", str_models[iM].Data(), KSTest_norm[iM]);
+        for(int iS = 0; iS < KSTest_nStat; iS++)
+        {
+            Long64_t n = 0;
+            for(int iThr = 0; iThr < nThr; iThr++) n += counts[iThr][iM * KSTest_nStat + iS];
+            double p = (double)n / nToys;
+            double err = TMath::Sqrt(p * (1. - p) / nToys);
+            os << "\t" << KSTest_obs[iM][iS] << "\t" << p << "\t" << err;
+            str_print += Form(" | %s %.3f p %.4f", KSTest_strStat[iS].Data(), KSTest_obs[iM][iS], p);
+        }
+        os << "\n";
+        Printf("%s", str_print.Data());
+    }
+    os.close();
+    Printf("Results printed to %s.", str_out.Data());
+
+    return;
+}
+
+void CrossSec_KSTest(int iAnalysis, int nToys = 100000, int nThr = 4, int seed = 1)
 {
     InitAnalysis(iAnalysis);
     InitObjects();
@@ -115,6 +317,7 @@ void CrossSec_KSTest(int iAnalysis)
     for(int i = 0; i < 9; i++) hBinned_models[i] = (TH1F*)lh->FindObject("hBinned_" + str_models[i]);
     // data graph & histo
     gr_data_uncr = (TGraphAsymmErrors*)lg->FindObject("gr_data_uncr");
+    gr_data_corr = (TGraphAsymmErrors*)lg->FindObject("gr_data_corr");
     hBinned_data = new TH1F("hBinned_data","",nPtBins,tBoundaries);
     for(int i = 1; i <= nPtBins; i++) {
         hBinned_data->SetBinContent(i, gr_data_uncr->GetPointY(i-1));
@@ -123,5 +326,7 @@ void CrossSec_KSTest(int iAnalysis)
 
     for(int i = 0; i < 9; i++) DoKSTest(i);
 
+    KSTest_Compatibility(nToys, nThr, seed);
+
     return;
 }
\ No newline at end of file
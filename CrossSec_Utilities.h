@@ -1,6 +1,9 @@
 // CrossSec_Utilities.h
 // David Grund, Sep 3, 2022
 
+#ifndef CrossSec_Utilities_h
+#define CrossSec_Utilities_h
+
 // c++ headers
 #include <iostream>
 #include <fstream>
@@ -26,6 +29,7 @@
 #include "AnalysisManager.h"
 #include "AnalysisConfig.h"
 #include "SetPtBinning.h"
+#include "ModelStore.h"
 
 TString str_data = "data";
 TGraphAsymmErrors* gr_data_uncr = NULL;
@@ -200,19 +204,19 @@ Double_t IntegrateData()
     return integral;
 }
 
+// fills the graph with the nodes of the curve iC of the model store
+void FillGraphFromStore(TGraph *gr, Int_t iC)
+{
+    for(Int_t i = 0; i < ModelStore_GetN(iC); i++) gr->SetPoint(i,ModelStore_t[iC][i],ModelStore_sig[iC][i]);
+    return;
+}
+
 // the STARlight model
 void LoadGraphs_SL(Bool_t print = kFALSE)
 {
-    ifstream ifs;
-    ifs.open("Trees/PhotoCrossSec/STARlight/IncJ_tDep_0.00-2.50.txt");
-    for(Int_t i = 0; i < 125; i++)
-    {
-        // cross section values in mb
-        Double_t abs_t_val(0.), sigma_val(0.);
-        ifs >> abs_t_val >> sigma_val;
-        gr_models[0]->SetPoint(i,abs_t_val,sigma_val);
-    }
-    ifs.close();
+    if(!ModelStore_Load(0)) return;
+    // cross section values in mb
+    FillGraphFromStore(gr_models[0],0);
     Printf("TGraph for STARlight created.");
     if(print) gr_models[0]->Print();
 
@@ -222,26 +226,10 @@ void LoadGraphs_SL(Bool_t print = kFALSE)
 // the CCK (hot-spot) model
 void LoadGraphs_CCK(Bool_t print = kFALSE)
 {
-    ifstream ifs;
-    ifs.open("Trees/PhotoCrossSec/HSModel/data-dtdy-y_0.6-Run1.txt");
-    for(Int_t i = 0; i < 75; i++)
-    {
-        // cross section values in mb
-        Double_t x(0.), tmp, abs_t_val(0.), 
-            sig_coh_n_val(0.), sig_coh_n_err(0.), 
-            sig_inc_n_val(0.), sig_inc_n_err(0.), 
-            sig_coh_hs_val(0.), sig_coh_hs_err(0.), 
-            sig_inc_hs_val(0.), sig_inc_hs_err(0.);
-        ifs >> x >> tmp >> tmp
-            >> abs_t_val
-            >> sig_coh_n_val >> sig_coh_n_err
-            >> sig_inc_n_val >> sig_inc_n_err
-            >> sig_coh_hs_val >> sig_coh_hs_err
-            >> sig_inc_hs_val >> sig_inc_hs_err;
-        gr_models[1]->SetPoint(i,abs_t_val,sig_inc_hs_val); // CCK-hs
-        gr_models[2]->SetPoint(i,abs_t_val,sig_inc_n_val);  // CCK-n
-    }
-    ifs.close();
+    if(!ModelStore_Load(1)) return;
+    // cross section values in mb
+    FillGraphFromStore(gr_models[1],1); // CCK-hs
+    FillGraphFromStore(gr_models[2],2); // CCK-n
     Printf("TGraphs for CCK created.");
     if(print)
     {
@@ -255,24 +243,9 @@ void LoadGraphs_CCK(Bool_t print = kFALSE)
 // the MS (IPsat) model
 void LoadGraphs_MS(Bool_t print = kFALSE)
 {
-    ifstream ifs;
-    ifs.open("Trees/PhotoCrossSec/Heikki/ipsat_hight_alice_112021/no_photon_flux/incoherent_fluct");
-    for(Int_t i = 0; i < 183; i++)
-    {
-        // cross section values in mb
-        Double_t abs_t_val(0.), sigma_val(0.);
-        ifs >> abs_t_val >> sigma_val;
-        gr_models[3]->SetPoint(i,abs_t_val,sigma_val); // MS-hs
-    }
-    ifs.close();
-    ifs.open("Trees/PhotoCrossSec/Heikki/ipsat_hight_alice_112021/no_photon_flux/incoherent_nofluct");
-    for(Int_t i = 0; i < 183; i++)
-    {
-        Double_t abs_t_val(0.), sigma_val(0.);
-        ifs >> abs_t_val >> sigma_val;
-        gr_models[4]->SetPoint(i,abs_t_val,sigma_val); // MS-n
-    }
-    ifs.close();
+    // cross section values in mb (two tables, each loaded on its own)
+    if(ModelStore_Load(3)) FillGraphFromStore(gr_models[3],3); // MS-hs
+    if(ModelStore_Load(4)) FillGraphFromStore(gr_models[4],4); // MS-n
     Printf("TGraphs for MS created.");
     if(print)
     {
@@ -286,49 +259,28 @@ void LoadGraphs_MS(Bool_t print = kFALSE)
 // the GSZ model
 void LoadGraphs_GSZ(Bool_t print = kFALSE)
 {
-    Double_t abs_t_val[100] = { 0 };
-    Double_t sig_el_min[100] = { 0 };
-    Double_t sig_el_max[100] = { 0 };
-    Double_t sig_diss_min[100] = { 0 };
-    Double_t sig_diss_max[100] = { 0 };
-    Double_t sig_tot_min[100] = { 0 };
-    Double_t sig_tot_max[100] = { 0 };
-    ifstream ifs;
-    ifs.open("Trees/PhotoCrossSec/Guzey/incoh_tdep_nuc_run2.dat");
-    for(Int_t i = 0; i < 100; i++)
+    if(!ModelStore_Load(5)) return;
+    // cross section values in mb (the store keeps the middle of the band and its limits)
+    FillGraphFromStore(gr_models[5],5); // GSZ-el+diss
+    FillGraphFromStore(gr_models[6],6); // GSZ-el
+    // fill graphs showing the error bands and determine the scales
+    for(Int_t iErr = 0; iErr < 2; iErr++)
     {
-        // cross section values in nb
-        ifs >> abs_t_val[i]
-            >> sig_el_min[i] >> sig_el_max[i]
-            >> sig_diss_min[i] >> sig_diss_max[i]
-            >> sig_tot_min[i] >> sig_tot_max[i];
-        // transfer to mb:
-        Double_t sig_el_mid = (sig_el_max[i] + sig_el_min[i]) / 2 / 1e6;
-        Double_t sig_tot_mid = (sig_tot_max[i] + sig_tot_min[i]) / 2 / 1e6;
-        gr_models[5]->SetPoint(i,abs_t_val[i],sig_tot_mid); // GSZ-el+diss
-        gr_models[6]->SetPoint(i,abs_t_val[i],sig_el_mid);  // GSZ-el
-    }
-    ifs.close();
-    // fill graphs showing the error bands
-    for (Int_t i = 0; i < 100; i++)
-    {
-        gr_GSZ_err[0]->SetPoint(i, abs_t_val[i], sig_tot_max[i] / 1e6);
-        gr_GSZ_err[0]->SetPoint(100+i, abs_t_val[100-i-1], sig_tot_min[100-i-1] / 1e6);
-        gr_GSZ_err[1]->SetPoint(i, abs_t_val[i], sig_el_max[i] / 1e6);
-        gr_GSZ_err[1]->SetPoint(100+i, abs_t_val[100-i-1], sig_el_min[100-i-1] / 1e6);
-    }
-    // determine the scales
-    for(Int_t i = 0; i < 100; i++)
-    {
-        GSZ_err_scale_upp[0] += sig_tot_max[i] / ((sig_tot_max[i] + sig_tot_min[i]) / 2.);
-        GSZ_err_scale_low[0] += sig_tot_min[i] / ((sig_tot_max[i] + sig_tot_min[i]) / 2.);
-        GSZ_err_scale_upp[1] += sig_el_max[i] / ((sig_el_max[i] + sig_el_min[i]) / 2.);
-        GSZ_err_scale_low[1] += sig_el_min[i] / ((sig_el_max[i] + sig_el_min[i]) / 2.);
-    }
-    for(Int_t i = 0; i < 2; i++)
-    {
-        GSZ_err_scale_upp[i] = GSZ_err_scale_upp[i] / 100.;
-        GSZ_err_scale_low[i] = GSZ_err_scale_low[i] / 100.;
+        Int_t iMid = 5 + iErr;
+        Int_t iMax = 9 + 2*iErr;
+        Int_t iMin = 10 + 2*iErr;
+        Int_t n = ModelStore_GetN(iMid);
+        GSZ_err_scale_upp[iErr] = 0.;
+        GSZ_err_scale_low[iErr] = 0.;
+        for(Int_t i = 0; i < n; i++)
+        {
+            gr_GSZ_err[iErr]->SetPoint(i, ModelStore_t[iMax][i], ModelStore_sig[iMax][i]);
+            gr_GSZ_err[iErr]->SetPoint(n+i, ModelStore_t[iMin][n-i-1], ModelStore_sig[iMin][n-i-1]);
+            GSZ_err_scale_upp[iErr] += ModelStore_sig[iMax][i] / ModelStore_sig[iMid][i];
+            GSZ_err_scale_low[iErr] += ModelStore_sig[iMin][i] / ModelStore_sig[iMid][i];
+        }
+        GSZ_err_scale_upp[iErr] = GSZ_err_scale_upp[iErr] / n;
+        GSZ_err_scale_low[iErr] = GSZ_err_scale_low[iErr] / n;
     }
     Printf("TGraphs for GSZ created");
     if(print)
@@ -353,24 +305,9 @@ void LoadGraphs_GSZ(Bool_t print = kFALSE)
 // the MSS (CGC) model
 void LoadGraphs_MSS(Bool_t print = kFALSE)
 {
-    ifstream ifs;
-    ifs.open("Trees/PhotoCrossSec/Heikki_new/cgc_with_shapefluct.txt"); 
-    for(Int_t i = 0; i < 696; i++)
-    {
-        // cross section values in mb
-        Double_t abs_t_val(0.), sigma_val(0.);
-        ifs >> abs_t_val >> sigma_val;
-        gr_models[7]->SetPoint(i,abs_t_val,sigma_val); // MSS-CGC+fluct
-    }
-    ifs.close();
-    ifs.open("Trees/PhotoCrossSec/Heikki_new/cgc_no_shapefluct.txt"); 
-    for(Int_t i = 0; i < 696; i++)
-    {
-        Double_t abs_t_val(0.), sigma_val(0.);
-        ifs >> abs_t_val >> sigma_val;
-        gr_models[8]->SetPoint(i,abs_t_val,sigma_val); // MSS-CGC
-    }
-    ifs.close();
+    // cross section values in mb (two tables, each loaded on its own)
+    if(ModelStore_Load(7)) FillGraphFromStore(gr_models[7],7); // MSS-CGC+fluct
+    if(ModelStore_Load(8)) FillGraphFromStore(gr_models[8],8); // MSS-CGC
     Printf("TGraphs for MSS created.");
     if(print)
     {
@@ -457,41 +394,19 @@ void CreateHistogramFromGraph(Int_t iM, Bool_t print = kTRUE) // iM = index of a
 }
 
 Bool_t IntegrateModel(Int_t iM, Double_t t_min, Double_t t_max, Double_t &integral, Double_t &avgt) // iM = index of a model
-// this function works for t_min, t_max in the range 0.04 to 1.0
+// exact integral of the interpolated model (see ModelStore.h) and the mean |t| in (t_min, t_max)
 {
     gSystem->Exec("mkdir -p Results/" + str_subfolder + "CrossSec/Integrals/");
     integral = 0; avgt = 0;
     if(t_max < t_min) return kFALSE; // undefined, return false
     if(t_min == t_max) return kTRUE; // if the borders are equal, return zeros and true
-    Int_t iBinMin = h_models[iM]->FindBin(t_min);
-    Int_t iBinMax = h_models[iM]->FindBin(t_max);
-    // if we integrate only within one bin:
-    if(iBinMin == iBinMax){
-        integral += h_models[iM]->GetBinContent(iBinMin) * (t_max - t_min);
-        avgt = t_max + t_min / 2.;
-    } 
-    // if we integrate within at least two bins:
-    else {
-        // first bin
-        Double_t first_integral = (h_models[iM]->GetBinLowEdge(iBinMin+1) - t_min) * h_models[iM]->GetBinContent(iBinMin);
-        Double_t first_center = (t_min + h_models[iM]->GetBinLowEdge(iBinMin+1)) / 2.;
-        integral += first_integral;
-        avgt     += first_integral * first_center;
-        // last bin
-        Double_t last_integral = (t_max - h_models[iM]->GetBinLowEdge(iBinMax)) * h_models[iM]->GetBinContent(iBinMax);
-        Double_t last_center = (h_models[iM]->GetBinLowEdge(iBinMax) + t_max) / 2.;
-        integral += last_integral;
-        avgt     += last_integral * last_center;
-        // if within more than two bins => integral in between the first and last bins:
-        if(iBinMax > iBinMin+1){
-            for(Int_t i = iBinMin+1; i <= iBinMax-1; i++) {
-                integral += (h_models[iM]->GetBinLowEdge(i+1) - h_models[iM]->GetBinLowEdge(i)) * h_models[iM]->GetBinContent(i);
-                avgt     += (h_models[iM]->GetBinLowEdge(i+1) - h_models[iM]->GetBinLowEdge(i)) * h_models[iM]->GetBinContent(i) * h_models[iM]->GetBinCenter(i);
-            }
-            //integral += h_models[iM]->Integral(iBinMin+1, iBinMax-1, "width"); // alternative
-        } 
-    }
-    avgt = avgt / integral; 
+    ModelStore_Load(); // all curves, the bin averages below are calculated for all models
+    if(!ModelStore_IsLoaded(iM)) return kFALSE;
+    Double_t edges[2] = {t_min, t_max};
+    std::vector<Double_t> avg[ModelStore_nModels], avg_t[ModelStore_nModels];
+    ModelStore_BinAverages(1, edges, avg, avg_t);
+    integral = avg[iM][0] * (t_max - t_min);
+    avgt = avg_t[iM][0];
     // print the results
     ofstream os;
     os.open("Results/" + str_subfolder + "CrossSec/Integrals/" + Form("%s %.3f-%.3f GeV.txt", str_models[iM].Data(), t_min, t_max)); 
@@ -504,8 +419,6 @@ Bool_t IntegrateModel(Int_t iM, Double_t t_min, Double_t t_max, Double_t &integr
     // print to the console
     Printf(" +++++++++++++++++++++++++++++++++++++++");
     Printf(" %s, range (%.3f,%.3f) GeV", str_models[iM].Data(), t_min, t_max);
-    Printf(" iBinMin: %i \tbin range: (%.3f,%.3f) GeV", iBinMin, h_models[iM]->GetBinLowEdge(iBinMin), h_models[iM]->GetBinLowEdge(iBinMin+1));
-    Printf(" iBinMax: %i \tbin range: (%.3f,%.3f) GeV", iBinMax, h_models[iM]->GetBinLowEdge(iBinMax), h_models[iM]->GetBinLowEdge(iBinMax+1));
     Printf(" integral: %.3f mub", integral * 1e3);
     Printf(" avg |t| : %.3f GeV", avgt);
     Printf(" +++++++++++++++++++++++++++++++++++++++");
@@ -546,4 +459,6 @@ void SetupSysErrorBox(TGraph* g, Color_t color)
     g->SetFillStyle(1001);
     g->SetFillColorAlpha(color,0.35);
     SetStyle(g,color,1,0);
-}
\ No newline at end of file
+}
+
+#endif
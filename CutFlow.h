@@ -0,0 +1,421 @@
+// CutFlow.h
+// David Grund, Oct 19, 2026
+// Cut flow of the data (CountEvents.C) and of the kIncohJpsiToMu MC (CountEvents_MC.C) per run:
+// a matrix run x cut with the number of events that passed the selections up to the given one
+//  - the tree is divided among nWorkers forked processes, each reading its own range of entries
+//    into its own block of counters (run -> counters), no counter is shared between the workers
+//  - each worker writes its block to a file, the parent sums them once all the workers finished
+//  - the counts of LHC18q, LHC18r or both are sums over the rows of the matrix (one pass of the tree
+//    instead of one per period), RunListCheck.C takes the list of runs from it
+// The matrix is saved to Results/<subfolder>/CountEvents[_MC]/cuts_per_run.txt and recreated
+// only if the input or the selection changed (see StageCache.h).
+
+#ifndef CutFlow_h
+#define CutFlow_h
+
+// cpp headers
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+// root headers
+#include "TSystem.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TString.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+
+const Int_t CutFlow_nCutsData = 18;
+const Int_t CutFlow_nCutsMC = 19;
+const Int_t CutFlow_firstRun18r = 296690;
+
+// run -> number of events that passed the selections 0, 1, 2, ... (see CutFlow_Data() and CutFlow_MC())
+std::map<Int_t, std::vector<Long64_t>> CutFlow_matrix;
+
+// the selections of CountEvents.C (counters 16 and 17 are not used)
+// returns the bits of the counters that the current event increments
+UInt_t CutFlow_Data()
+{
+    UInt_t bits = 0;
+
+    // if pass1
+    if(!isPass3){
+        // Selections applied on the GRID:
+        // 0) fEvent non-empty
+        // 1) At least two tracks associated with the vertex
+        // 2) Distance from the IP lower than 15 cm
+        // 3) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
+        // 4) Central UPC trigger CCUP31:
+        // for fRunNumber < 295881: CCUP31-B-NOPF-CENTNOTRD
+        // for fRunNumber >= 295881: CCUP31-B-SPD2-CENTNOTRD
+        bits |= 1u << 0;
+
+    // if pass3
+    } else {
+        // Selections applied on the GRID:
+        // 0) fEvent non-empty
+        // 1) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
+        // 2) Central UPC trigger CCUP31:
+        // for fRunNumber < 295881: CCUP31-B-NOPF-CENTNOTRD
+        // for fRunNumber >= 295881: CCUP31-B-SPD2-CENTNOTRD
+        bits |= 1u << 0;
+
+        // 3) At least two tracks associated with the vertex
+        if(fVertexContrib < cut_fVertexContrib) return bits;
+        bits |= 1u << 1;
+
+        // 4) Distance from the IP lower than cut_fVertexZ
+        if(fVertexZ > cut_fVertexZ) return bits;
+        bits |= 1u << 2;
+    }
+
+    // 5) Run numbers from the DPG list
+    if(!RunNumberInListOfGoodRuns()) return bits;
+    bits |= 1u << 3;
+
+    // 6a) ADA offline veto (no effect on MC)
+    if(!(fADA_dec == 0)) return bits;
+    bits |= 1u << 4;
+
+    // 6b) ADC offline veto (no effect on MC)
+    if(!(fADC_dec == 0)) return bits;
+    bits |= 1u << 5;
+
+    // 7a) V0A offline veto (no effect on MC)
+    if(!(fV0A_dec == 0)) return bits;
+    bits |= 1u << 6;
+
+    // 7b) V0C offline veto (no effect on MC)
+    if(!(fV0C_dec == 0)) return bits;
+    bits |= 1u << 7;
+
+    // 8) SPD cluster matches FOhits
+    if(!(fMatchingSPD == kTRUE)) return bits;
+    bits |= 1u << 8;
+
+    // 9) Muon pairs only
+    if(!(fTrk1SigIfMu*fTrk1SigIfMu + fTrk2SigIfMu*fTrk2SigIfMu < fTrk1SigIfEl*fTrk1SigIfEl + fTrk2SigIfEl*fTrk2SigIfEl)) return bits;
+    bits |= 1u << 9;
+
+    // 10) Dilepton rapidity |y| < cut_fY
+    if(!(abs(fY) < cut_fY)) return bits;
+    bits |= 1u << 10;
+
+    // 11) Pseudorapidity of both tracks |eta| < cut_fEta
+    if(!(abs(fEta1) < cut_fEta && abs(fEta2) < cut_fEta)) return bits;
+    bits |= 1u << 11;
+
+    // 12) Tracks have opposite charges
+    if(!(fQ1 * fQ2 < 0)) return bits;
+    bits |= 1u << 12;
+
+    // 13) Invariant mass between 2.2 and 4.5 GeV/c^2
+    if(!(fM > 2.2 && fM < 4.5)) return bits;
+    bits |= 1u << 13;
+
+    // 14) Transverse momentum cut
+    if(!(fPt > 0.20 && fPt < 1.00)) return bits;
+    bits |= 1u << 14;
+
+    // 15) Invariant mass between 3.0 and 3.2 GeV/c^2
+    if(!(fM > 3.0 && fM < 3.2)) return bits;
+    bits |= 1u << 15;
+
+    // Event passed all the selections =>
+    return bits;
+}
+
+// the selections of CountEvents_MC.C
+// returns the bits of the counters that the current event increments
+UInt_t CutFlow_MC()
+{
+    UInt_t bits = 0;
+
+    // if pass1
+    if(!isPass3){
+        // Selections applied on the GRID:
+        // 0) fEvent non-empty
+        // 1) At least two tracks associated with the vertex
+        // 2) Distance from the IP lower than 15 cm
+        // 3) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
+        bits |= 1u << 0;
+
+    // if pass3
+    } else {
+        // Selections applied on the GRID:
+        // 0) fEvent non-empty
+        // 1) nGoodTracksTPC == 2 && nGoodTracksSPD == 2
+        bits |= 1u << 0;
+
+        // 2) At least two tracks associated with the vertex
+        if(fVertexContrib < cut_fVertexContrib) return bits;
+        bits |= 1u << 1;
+
+        // 3) Distance from the IP lower than cut_fVertexZ
+        if(fVertexZ > cut_fVertexZ) return bits;
+        bits |= 1u << 2;
+    }
+
+    // 4) Central UPC trigger CCUP31
+    Bool_t CCUP31 = kFALSE;
+    if(
+        !fTriggerInputsMC[0] &&  // !0VBA (no signal in the V0A)
+        !fTriggerInputsMC[1] &&  // !0VBC (no signal in the V0C)
+        !fTriggerInputsMC[2] &&  // !0UBA (no signal in the ADA)
+        !fTriggerInputsMC[3] &&  // !0UBC (no signal in the ADC)
+        fTriggerInputsMC[10] &&  //  0STG (SPD topological)
+        fTriggerInputsMC[4]      //  0OMU (TOF two hits topology)
+    ) CCUP31 = kTRUE;
+    if(!CCUP31) return bits;
+    bits |= 1u << 3;
+
+    // 5) Run numbers from the DPG list
+    if(!RunNumberInListOfGoodRuns()) return bits;
+    bits |= 1u << 4;
+
+    // 6a) ADA offline veto (no effect on MC)
+    if(!(fADA_dec == 0)) return bits;
+    bits |= 1u << 5;
+
+    // 6b) ADC offline veto (no effect on MC)
+    if(!(fADC_dec == 0)) return bits;
+    bits |= 1u << 6;
+
+    // 7a) V0A offline veto (no effect on MC)
+    if(!(fV0A_dec == 0)) return bits;
+    bits |= 1u << 7;
+
+    // 7b) V0C offline veto (no effect on MC)
+    if(!(fV0C_dec == 0)) return bits;
+    bits |= 1u << 8;
+
+    // 8) SPD cluster matches FOhits
+    if(!(fMatchingSPD == kTRUE)) return bits;
+    bits |= 1u << 9;
+
+    // 9) Muon pairs only
+    if(!(fTrk1SigIfMu*fTrk1SigIfMu + fTrk2SigIfMu*fTrk2SigIfMu < fTrk1SigIfEl*fTrk1SigIfEl + fTrk2SigIfEl*fTrk2SigIfEl)) return bits;
+    bits |= 1u << 10;
+
+    // 10) Dilepton rapidity |y| < cut_fY
+    if(!(abs(fY) < cut_fY)) return bits;
+    bits |= 1u << 11;
+
+    // 11) Pseudorapidity of both tracks |eta| < cut_fEta
+    if(!(abs(fEta1) < cut_fEta && abs(fEta2) < cut_fEta)) return bits;
+    bits |= 1u << 12;
+
+    // 12) Tracks have opposite charges
+    if(!(fQ1 * fQ2 < 0)) return bits;
+    bits |= 1u << 13;
+
+    // 13) Invariant mass between 2.2 and 4.5 GeV/c^2
+    if(!(fM > 2.2 && fM < 4.5)) return bits;
+    bits |= 1u << 14;
+
+    // 14) Transverse momentum cut
+    if(!(fPt > 0.20)) return bits;
+    bits |= 1u << 15;
+
+    // 15) Invariant mass between 3.0 and 3.2 GeV/c^2
+    if(!(fM > 3.0 && fM < 3.2)) return bits;
+    bits |= 1u << 16;
+
+    // Event passed all the selections =>
+    return bits;
+}
+
+TString CutFlow_InputFile(Bool_t isMC)
+{
+    if(!isMC) return str_in_DT_fldr + "AnalysisResults.root";
+    else      return str_in_MC_fldr_rec + "AnalysisResults_MC_kIncohJpsiToMu.root";
+}
+
+TString CutFlow_FileName(Bool_t isMC)
+{
+    if(!isMC) return "Results/" + str_subfolder + "CountEvents/cuts_per_run.txt";
+    else      return "Results/" + str_subfolder + "CountEvents_MC/cuts_per_run.txt";
+}
+
+Int_t CutFlow_nCuts(Bool_t isMC)
+{
+    return isMC ? CutFlow_nCutsMC : CutFlow_nCutsData;
+}
+
+void CutFlow_Write(std::map<Int_t, std::vector<Long64_t>> &matrix, Int_t nCuts, TString name)
+{
+    ofstream of(name.Data());
+    of << "run";
+    for(Int_t iCut = 0; iCut < nCuts; iCut++) of << "\t" << iCut;
+    of << "\n";
+    for(std::map<Int_t, std::vector<Long64_t>>::iterator it = matrix.begin(); it != matrix.end(); ++it)
+    {
+        of << it->first;
+        for(Int_t iCut = 0; iCut < nCuts; iCut++) of << "\t" << it->second[iCut];
+        of << "\n";
+    }
+    of.close();
+
+    return;
+}
+
+// adds the matrix stored in name to CutFlow_matrix
+Bool_t CutFlow_Read(Int_t nCuts, TString name)
+{
+    ifstream ifs(name.Data());
+    if(ifs.fail()) return kFALSE;
+    std::string header;
+    std::getline(ifs, header);
+    Int_t run;
+    while(ifs >> run)
+    {
+        std::vector<Long64_t> &row = CutFlow_matrix[run];
+        row.resize(nCuts, 0);
+        for(Int_t iCut = 0; iCut < nCuts; iCut++)
+        {
+            Long64_t n;
+            ifs >> n;
+            row[iCut] += n;
+        }
+    }
+    ifs.close();
+
+    return kTRUE;
+}
+
+// counts the events of the entries [iWorker/nWorkers, (iWorker+1)/nWorkers) of the tree
+void CutFlow_Worker(Bool_t isMC, Int_t iWorker, Int_t nWorkers, TString name)
+{
+    TFile *f = TFile::Open(CutFlow_InputFile(isMC).Data(), "read");
+    if(!f) return;
+    TTree *t = dynamic_cast<TTree*> (f->Get(!isMC ? str_in_DT_tree.Data() : str_in_MC_tree_rec.Data()));
+    if(!t) return;
+    if(!isMC) ConnectTreeVariables(t);
+    else      ConnectTreeVariablesMCRec(t);
+
+    Int_t nCuts = CutFlow_nCuts(isMC);
+    Long64_t nEntries = t->GetEntries();
+    Long64_t first = nEntries * iWorker / nWorkers;
+    Long64_t last = nEntries * (iWorker+1) / nWorkers;
+    std::map<Int_t, std::vector<Long64_t>> block;
+    // the counters of the current run (the entries are ordered by run, so the map is rarely searched)
+    Int_t run = -1;
+    std::vector<Long64_t> *counters = NULL;
+    for(Long64_t iEntry = first; iEntry < last; iEntry++)
+    {
+        t->GetEntry(iEntry);
+        if(fRunNumber != run || !counters)
+        {
+            run = fRunNumber;
+            counters = &block[run];
+            if((Int_t)counters->size() < nCuts) counters->resize(nCuts, 0);
+        }
+        UInt_t bits = !isMC ? CutFlow_Data() : CutFlow_MC();
+        for(Int_t iCut = 0; bits; iCut++, bits >>= 1) (*counters)[iCut] += (bits & 1u);
+
+        if(iWorker == 0 && (iEntry+1-first) % 100000 == 0) Printf("Worker 0: %lli of %lli entries analysed.", iEntry+1-first, last-first);
+    }
+    f->Close();
+
+    CutFlow_Write(block, nCuts, name);
+
+    return;
+}
+
+Bool_t CutFlow_Create(Bool_t isMC, Int_t nWorkers, TString name)
+{
+    if(nWorkers < 1) nWorkers = 1;
+    TString folder = gSystem->DirName(name.Data());
+    gSystem->Exec("mkdir -p " + folder);
+
+    // each worker writes its block of counters to its own file
+    std::vector<TString> names;
+    for(Int_t iWorker = 0; iWorker < nWorkers; iWorker++)
+    {
+        names.push_back(name + Form(".w%i", iWorker));
+        gSystem->Unlink(names[iWorker].Data());
+    }
+    std::vector<pid_t> pids;
+    for(Int_t iWorker = 0; iWorker < nWorkers; iWorker++)
+    {
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            CutFlow_Worker(isMC, iWorker, nWorkers, names[iWorker]);
+            _exit(0);
+        }
+        // the process cannot be forked: the block is counted by the current process
+        if(pid < 0)
+        {
+            Printf("Worker %i cannot be forked, its entries are analysed by the main process.", iWorker);
+            CutFlow_Worker(isMC, iWorker, nWorkers, names[iWorker]);
+            continue;
+        }
+        pids.push_back(pid);
+    }
+    for(UInt_t i = 0; i < pids.size(); i++) waitpid(pids[i], NULL, 0);
+
+    // sum the blocks
+    Int_t nCuts = CutFlow_nCuts(isMC);
+    CutFlow_matrix.clear();
+    Bool_t ok = kTRUE;
+    for(Int_t iWorker = 0; iWorker < nWorkers; iWorker++)
+    {
+        if(!CutFlow_Read(nCuts, names[iWorker]))
+        {
+            Printf("Worker %i failed to read %s.", iWorker, CutFlow_InputFile(isMC).Data());
+            ok = kFALSE;
+        }
+        gSystem->Unlink(names[iWorker].Data());
+    }
+    if(!ok) return kFALSE;
+    CutFlow_Write(CutFlow_matrix, nCuts, name);
+    Printf("Cut flow of %i runs saved to %s.", (Int_t)CutFlow_matrix.size(), name.Data());
+
+    return kTRUE;
+}
+
+Bool_t CutFlow_Load(Bool_t isMC, Int_t nWorkers = 8)
+{
+    TString name = CutFlow_FileName(isMC);
+    TString stage = !isMC ? "CutFlow_Data" : "CutFlow_MC";
+    TString key = StageCache_Key(stage, 1, {CutFlow_InputFile(isMC), "CutFlow.h", "AnalysisManager.h", "ListsOfGoodRuns.h"}, AnalysisConfig_ToString());
+    if(!StageCache_IsUpToDate(name, key))
+    {
+        if(!CutFlow_Create(isMC, nWorkers, name)) return kFALSE;
+        StageCache_Update(name, key, stage);
+    }
+    else
+    {
+        CutFlow_matrix.clear();
+        if(!CutFlow_Read(CutFlow_nCuts(isMC), name)) return kFALSE;
+        Printf("Cut flow of %i runs loaded from %s.", (Int_t)CutFlow_matrix.size(), name.Data());
+    }
+
+    return kTRUE;
+}
+
+// number of events that passed the selections up to iCut
+// period == 0 => both
+//        == 1 => LHC18q
+//        == 2 => LHC18r
+Long64_t CutFlow_Sum(Int_t iCut, Int_t period = 0)
+{
+    Long64_t sum = 0;
+    for(std::map<Int_t, std::vector<Long64_t>>::iterator it = CutFlow_matrix.begin(); it != CutFlow_matrix.end(); ++it)
+    {
+        if(period == 1 && it->first >= CutFlow_firstRun18r) continue;
+        if(period == 2 && it->first <  CutFlow_firstRun18r) continue;
+        sum += it->second[iCut];
+    }
+
+    return sum;
+}
+
+#endif
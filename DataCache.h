@@ -0,0 +1,303 @@
+// DataCache.h
+// David Grund, Oct 19, 2026
+// Columnar cache of the data tree (AnalysisOutput/fTreeJpsi) for repeated scans
+// The needed branches are exported once to a flat binary file:
+//  - header: magic "JPSICOL1", number of rows, number of columns, table of columns (name, type, offset)
+//  - data: one contiguous array per column, each starting at a page boundary (4096 bytes)
+// The file is then memory-mapped: a scan only touches the pages of the columns it reads
+// and starts immediately (no decompression, no TTree setup).
+// Usage (replaces ConnectTreeVariables + t->GetEntry):
+//  DataCache_Open();
+//  DataCache_SetActive({"fPt","fM"}); // only the columns the macro needs (by default all columns are read)
+//  for(Long64_t iEntry = 0; iEntry < DataCache_GetEntries(); iEntry++) { DataCache_GetEntry(iEntry); ... }
+// (the values are written to the global variables of AnalysisManager.h)
+
+#ifndef DataCache_h
+#define DataCache_h
+
+// cpp headers
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+// root headers
+#include "TSystem.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TString.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+
+const Long64_t DataCache_pageSize = 4096;
+const Int_t DataCache_nameLength = 32;
+
+struct DataCache_Column {
+    char name[DataCache_nameLength];
+    char type; // 'D' = Double_t, 'I' = Int_t, 'O' = Bool_t (as in the leaf lists of TTree)
+    char pad[3];
+    Int_t nVals; // number of values per row (arrays, e.g. fZNA_time[4])
+    Long64_t offset; // position of the column in the file
+};
+
+// columns of the cache and the global variables they are connected to
+// (the same variables as in ConnectTreeVariables, except for fTriggerName)
+std::vector<DataCache_Column> DataCache_cols;
+std::vector<void*> DataCache_addr;
+std::vector<Bool_t> DataCache_active;
+char *DataCache_map = NULL;
+Long64_t DataCache_mapSize = 0;
+Long64_t DataCache_nRows = 0;
+
+Int_t DataCache_TypeSize(char type)
+{
+    if(type == 'D') return sizeof(Double_t);
+    if(type == 'I') return sizeof(Int_t);
+    return sizeof(Bool_t);
+}
+
+void DataCache_AddColumn(const char *name, char type, void *address, Int_t nVals = 1)
+{
+    DataCache_Column col;
+    memset(&col, 0, sizeof(col));
+    strncpy(col.name, name, DataCache_nameLength - 1);
+    col.type = type;
+    col.nVals = nVals;
+    DataCache_cols.push_back(col);
+    DataCache_addr.push_back(address);
+    DataCache_active.push_back(kTRUE);
+
+    return;
+}
+
+void DataCache_DefineColumns()
+{
+    DataCache_cols.clear();
+    DataCache_addr.clear();
+    DataCache_active.clear();
+    DataCache_AddColumn("fRunNumber", 'I', &fRunNumber);
+    DataCache_AddColumn("fTrk1SigIfMu", 'D', &fTrk1SigIfMu);
+    DataCache_AddColumn("fTrk1SigIfEl", 'D', &fTrk1SigIfEl);
+    DataCache_AddColumn("fTrk2SigIfMu", 'D', &fTrk2SigIfMu);
+    DataCache_AddColumn("fTrk2SigIfEl", 'D', &fTrk2SigIfEl);
+    DataCache_AddColumn("fPt", 'D', &fPt);
+    DataCache_AddColumn("fPhi", 'D', &fPhi);
+    DataCache_AddColumn("fY", 'D', &fY);
+    DataCache_AddColumn("fM", 'D', &fM);
+    DataCache_AddColumn("fPt1", 'D', &fPt1);
+    DataCache_AddColumn("fPt2", 'D', &fPt2);
+    DataCache_AddColumn("fEta1", 'D', &fEta1);
+    DataCache_AddColumn("fEta2", 'D', &fEta2);
+    DataCache_AddColumn("fPhi1", 'D', &fPhi1);
+    DataCache_AddColumn("fPhi2", 'D', &fPhi2);
+    DataCache_AddColumn("fQ1", 'D', &fQ1);
+    DataCache_AddColumn("fQ2", 'D', &fQ2);
+    DataCache_AddColumn("fZNA_energy", 'D', &fZNA_energy);
+    DataCache_AddColumn("fZNC_energy", 'D', &fZNC_energy);
+    DataCache_AddColumn("fZNA_time", 'D', fZNA_time, 4);
+    DataCache_AddColumn("fZNC_time", 'D', fZNC_time, 4);
+    DataCache_AddColumn("fV0A_dec", 'I', &fV0A_dec);
+    DataCache_AddColumn("fV0C_dec", 'I', &fV0C_dec);
+    DataCache_AddColumn("fADA_dec", 'I', &fADA_dec);
+    DataCache_AddColumn("fADC_dec", 'I', &fADC_dec);
+    DataCache_AddColumn("fMatchingSPD", 'O', &fMatchingSPD);
+    if(isPass3){
+        DataCache_AddColumn("fVertexZ", 'D', &fVertexZ);
+        DataCache_AddColumn("fVertexContrib", 'I', &fVertexContrib);
+        DataCache_AddColumn("fTrk1dEdx", 'D', &fTrk1dEdx);
+        DataCache_AddColumn("fTrk2dEdx", 'D', &fTrk2dEdx);
+    } else {
+        DataCache_AddColumn("fV0A_time", 'D', &fV0A_time);
+        DataCache_AddColumn("fV0C_time", 'D', &fV0C_time);
+        DataCache_AddColumn("fADA_time", 'D', &fADA_time);
+        DataCache_AddColumn("fADC_time", 'D', &fADC_time);
+    }
+
+    return;
+}
+
+Long64_t DataCache_HeaderSize()
+{
+    return 8 + sizeof(Long64_t) + 2*sizeof(Int_t) + DataCache_cols.size() * sizeof(DataCache_Column);
+}
+
+Long64_t DataCache_AlignToPage(Long64_t pos)
+{
+    return ((pos + DataCache_pageSize - 1) / DataCache_pageSize) * DataCache_pageSize;
+}
+
+// stored next to the input data (shared by all analyses with the same pass)
+TString DataCache_FileName()
+{
+    return str_in_DT_fldr + "fTreeJpsi.cols";
+}
+
+Bool_t DataCache_Create(TString name)
+{
+    TFile *f_in = TFile::Open((str_in_DT_fldr + "AnalysisResults.root").Data(), "read");
+    if(!f_in) return kFALSE;
+    TTree *t_in = dynamic_cast<TTree*> (f_in->Get(str_in_DT_tree.Data()));
+    if(!t_in) return kFALSE;
+    Printf("Columnar cache will be created.");
+    // read only the exported branches
+    t_in->SetBranchStatus("*", 0);
+    for(UInt_t i = 0; i < DataCache_cols.size(); i++)
+    {
+        t_in->SetBranchStatus(DataCache_cols[i].name, 1);
+        t_in->SetBranchAddress(DataCache_cols[i].name, DataCache_addr[i]);
+    }
+
+    // layout of the file: header, then the columns, each aligned to a page
+    Long64_t nRows = t_in->GetEntries();
+    Long64_t pos = DataCache_AlignToPage(DataCache_HeaderSize());
+    for(UInt_t i = 0; i < DataCache_cols.size(); i++)
+    {
+        DataCache_cols[i].offset = pos;
+        pos = DataCache_AlignToPage(pos + nRows * DataCache_cols[i].nVals * DataCache_TypeSize(DataCache_cols[i].type));
+    }
+    Long64_t size = pos;
+
+    // written to a temporary file and renamed at the end, so that a cache that is being written
+    // (or whose writing failed) is never opened by another process
+    TString name_tmp = name + Form(".tmp%i", gSystem->GetPid());
+    Int_t fd = open(name_tmp.Data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || ftruncate(fd, size) != 0)
+    {
+        Printf("Cannot create %s.", name_tmp.Data());
+        if(fd >= 0) close(fd);
+        gSystem->Unlink(name_tmp.Data());
+        return kFALSE;
+    }
+    char *map = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        gSystem->Unlink(name_tmp.Data());
+        return kFALSE;
+    }
+
+    // header
+    Int_t nCols = DataCache_cols.size();
+    Int_t zero = 0;
+    char *p = map;
+    memcpy(p, "JPSICOL1", 8); p += 8;
+    memcpy(p, &nRows, sizeof(Long64_t)); p += sizeof(Long64_t);
+    memcpy(p, &nCols, sizeof(Int_t)); p += sizeof(Int_t);
+    memcpy(p, &zero, sizeof(Int_t)); p += sizeof(Int_t);
+    memcpy(p, &DataCache_cols[0], nCols * sizeof(DataCache_Column));
+
+    // data
+    Printf("%lli entries found in the tree.", nRows);
+    for(Long64_t iEntry = 0; iEntry < nRows; iEntry++)
+    {
+        t_in->GetEntry(iEntry);
+        for(Int_t i = 0; i < nCols; i++)
+        {
+            Long64_t bytes = DataCache_cols[i].nVals * DataCache_TypeSize(DataCache_cols[i].type);
+            memcpy(map + DataCache_cols[i].offset + iEntry * bytes, DataCache_addr[i], bytes);
+        }
+        if((iEntry+1) % 1000000 == 0) Printf("%lli entries exported.", iEntry+1);
+    }
+    munmap(map, size);
+    f_in->Close();
+    if(gSystem->Rename(name_tmp.Data(), name.Data()) != 0)
+    {
+        Printf("Cannot rename %s to %s.", name_tmp.Data(), name.Data());
+        gSystem->Unlink(name_tmp.Data());
+        return kFALSE;
+    }
+    Printf("Columnar cache %s created (%i columns, %lli rows).", name.Data(), nCols, nRows);
+
+    return kTRUE;
+}
+
+void DataCache_Close()
+{
+    if(DataCache_map) munmap(DataCache_map, DataCache_mapSize);
+    DataCache_map = NULL;
+    DataCache_mapSize = 0;
+    DataCache_nRows = 0;
+
+    return;
+}
+
+// open the cache of the data tree of the current analysis (InitAnalysis must be called first),
+// create it if it does not exist or if the input data changed
+Bool_t DataCache_Open()
+{
+    DataCache_Close();
+    DataCache_DefineColumns();
+
+    TString name = DataCache_FileName();
+    TString key = StageCache_Key("DataCache", 1, {str_in_DT_fldr + "AnalysisResults.root", "DataCache.h"}, Form("isPass3=%i;", isPass3));
+    if(!StageCache_IsUpToDate(name, key))
+    {
+        if(!DataCache_Create(name)) return kFALSE;
+        StageCache_Update(name, key, "DataCache");
+    }
+
+    Int_t fd = open(name.Data(), O_RDONLY);
+    if(fd < 0) return kFALSE;
+    DataCache_mapSize = lseek(fd, 0, SEEK_END);
+    DataCache_map = (char*)mmap(NULL, DataCache_mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(DataCache_map == MAP_FAILED)
+    {
+        DataCache_map = NULL;
+        return kFALSE;
+    }
+
+    // read the header and check it against the expected columns
+    char *p = DataCache_map;
+    if(strncmp(p, "JPSICOL1", 8) != 0) { DataCache_Close(); return kFALSE; }
+    p += 8;
+    memcpy(&DataCache_nRows, p, sizeof(Long64_t)); p += sizeof(Long64_t);
+    Int_t nCols = 0;
+    memcpy(&nCols, p, sizeof(Int_t)); p += 2*sizeof(Int_t);
+    if(nCols != (Int_t)DataCache_cols.size()) { DataCache_Close(); return kFALSE; }
+    for(Int_t i = 0; i < nCols; i++)
+    {
+        DataCache_Column col;
+        memcpy(&col, p + i * sizeof(DataCache_Column), sizeof(DataCache_Column));
+        if(strcmp(col.name, DataCache_cols[i].name) != 0) { DataCache_Close(); return kFALSE; }
+        DataCache_cols[i].offset = col.offset;
+    }
+    // the columns are read sequentially
+    madvise(DataCache_map, DataCache_mapSize, MADV_SEQUENTIAL);
+    Printf("Columnar cache %s opened (%lli entries).", name.Data(), DataCache_nRows);
+
+    return kTRUE;
+}
+
+// read only the listed columns (the pages of the others are never touched)
+void DataCache_SetActive(std::vector<TString> names)
+{
+    for(UInt_t i = 0; i < DataCache_cols.size(); i++)
+    {
+        DataCache_active[i] = kFALSE;
+        for(UInt_t j = 0; j < names.size(); j++) if(names[j] == DataCache_cols[i].name) DataCache_active[i] = kTRUE;
+    }
+
+    return;
+}
+
+Long64_t DataCache_GetEntries()
+{
+    return DataCache_nRows;
+}
+
+void DataCache_GetEntry(Long64_t iEntry)
+{
+    for(UInt_t i = 0; i < DataCache_cols.size(); i++)
+    {
+        if(!DataCache_active[i]) continue;
+        Long64_t bytes = DataCache_cols[i].nVals * DataCache_TypeSize(DataCache_cols[i].type);
+        memcpy(DataCache_addr[i], DataCache_map + DataCache_cols[i].offset + iEntry * bytes, bytes);
+    }
+
+    return;
+}
+
+#endif
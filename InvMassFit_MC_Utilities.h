@@ -141,7 +141,7 @@ void InvMassFit_MC_PrepareData()
     return;
 }
 
-void InvMassFit_MC_DoFit(Int_t opt, TString str_out, Bool_t isSystUncr = kFALSE, Double_t fCutZ = -1){
+void InvMassFit_MC_DoFit(Int_t opt, TString str_out){
     // Fit the invariant mass distribution using Double-sided CB function
     // Peak corresponding to psi(2s) excluded
 
@@ -220,16 +220,8 @@ void InvMassFit_MC_DoFit(Int_t opt, TString str_out, Bool_t isSystUncr = kFALSE,
 
     // Get the data trees
     TFile *f_in = NULL;
-    // ordinary fits:
-    if(isSystUncr == kFALSE) f_in = new TFile("Trees/" + str_subfolder + "InvMassFit_MC/InvMassFit_MC.root");
-    // systematic uncertainties 
-    else 
-    {
-        // related to signal extraction
-        if(fCutZ == cut_fVertexZ); // no action here at MC level
-        // related to modifications of Z vertex cut 
-        else f_in = new TFile("Trees/" + str_subfolder + Form("VertexZ_SystUncertainty/Zcut%.1f_InvMassFit_MC.root", fCutZ)); 
-    } 
+    // (variations of the cut on vertex Z are scanned by VertexZ_SystUncertainties.C without mass fits)
+    f_in = new TFile("Trees/" + str_subfolder + "InvMassFit_MC/InvMassFit_MC.root");
 
     TTree *t_in = NULL;
     if(opt == 0 || opt == 3 || opt == 4 || opt == 5 || opt == 6 || opt == 7 || opt == 8){
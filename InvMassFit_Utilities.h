@@ -1,6 +1,9 @@
 // InvMassFit_Utilities.h
 // David Grund, Apr 04, 2022
 
+#ifndef InvMassFit_Utilities_h
+#define InvMassFit_Utilities_h
+
 // cpp headers
 #include <fstream>
 #include <iomanip> // std::setprecision()
@@ -22,6 +25,10 @@
 #include "RooCBShape.h"
 #include "RooAddPdf.h"
 #include "RooWorkspace.h"
+// my headers
+#include "StageCache.h"
+#include "Skim_Utilities.h"
+#include "PlotStore.h"
 
 using namespace RooFit;
 
@@ -82,40 +89,27 @@ void InvMassFit_PrepareData(Int_t iMassCut)
     TString name;
     if(iMassCut == 0) name = "Trees/" + str_subfolder + "InvMassFit/InvMassFit.root";
     if(iMassCut == 2) name = "Trees/" + str_subfolder + "InvMassFit/InvMassFit_SystUncertainties.root";
-    TFile *file = TFile::Open(name.Data(),"read");
-    if(file){
-        Printf("Data trees already created.");
+    // the trees are derived from the skim of the data (see Skim_Utilities.h)
+    Skim_Create();
+    // recreate the trees only if the skim, the selection or the cuts changed
+    TString key = StageCache_Key("InvMassFit_PrepareData", 2, {Skim_FileName(), "InvMassFit_Utilities.h", "AnalysisManager.h", "ListsOfGoodRuns.h"},
+                                 AnalysisConfig_ToString() + Form("iMassCut=%i;", iMassCut));
+    if(StageCache_IsUpToDate(name, key)){
+        Printf("Data trees already created and up to date.");
         return;
 
     } else { 
 
         Printf("Data trees will be created.");
 
-        TFile *f_in = TFile::Open((str_in_DT_fldr + "AnalysisResults.root").Data(), "read");
-        if(f_in) Printf("Input data loaded.");
-
-        TTree *t_in = dynamic_cast<TTree*> (f_in->Get(str_in_DT_tree.Data()));
-        if(t_in) Printf("Input tree loaded.");
-
-        ConnectTreeVariables(t_in);
-
-        // Create new data tree with applied cuts
-        file = new TFile(name.Data(),"RECREATE");
-
-        TTree *tIncEnrSample = new TTree("tIncEnrSample", "tIncEnrSample");
-        tIncEnrSample->Branch("fPt", &fPt, "fPt/D");
-        tIncEnrSample->Branch("fM", &fM, "fM/D");
-        tIncEnrSample->Branch("fY", &fY, "fY/D");
+        TTree *t_in = Skim_Open();
+        if(t_in) Printf("Input skim loaded.");
 
-        TTree *tCohEnrSample = new TTree("tCohEnrSample", "tCohEnrSample");
-        tCohEnrSample->Branch("fPt", &fPt, "fPt/D");
-        tCohEnrSample->Branch("fM", &fM, "fM/D");
-        tCohEnrSample->Branch("fY", &fY, "fY/D");
-
-        TTree *tMixedSample = new TTree("tMixedSample", "tMixedSample");
-        tMixedSample->Branch("fPt", &fPt, "fPt/D");
-        tMixedSample->Branch("fM", &fM, "fM/D");
-        tMixedSample->Branch("fY", &fY, "fY/D");
+        // Create new data trees with applied cuts (float columns, LZ4)
+        TFile *file = Skim_NewFile(name);
+        TTree *tIncEnrSample = Skim_NewTree("tIncEnrSample", {"fPt", "fM", "fY"});
+        TTree *tCohEnrSample = Skim_NewTree("tCohEnrSample", {"fPt", "fM", "fY"});
+        TTree *tMixedSample = Skim_NewTree("tMixedSample", {"fPt", "fM", "fY"});
 
         Printf("%lli entries found in the tree.", t_in->GetEntries());
         Int_t nEntriesAnalysed = 0;
@@ -123,9 +117,9 @@ void InvMassFit_PrepareData(Int_t iMassCut)
         for(Int_t iEntry = 0; iEntry < t_in->GetEntries(); iEntry++){
             t_in->GetEntry(iEntry);
             // iMassCut (for syst uncertainties = 2, otherwise = 0), pT cut: inc, coh, all
-            if(EventPassed(iMassCut, 0)) tIncEnrSample->Fill();
-            if(EventPassed(iMassCut, 1)) tCohEnrSample->Fill();
-            if(EventPassed(iMassCut, 2)) tMixedSample->Fill();
+            if(Skim_EventPassed(iMassCut, 0)) tIncEnrSample->Fill();
+            if(Skim_EventPassed(iMassCut, 1)) tCohEnrSample->Fill();
+            if(Skim_EventPassed(iMassCut, 2)) tMixedSample->Fill();
 
             if((iEntry+1) % 100000 == 0){
                 nEntriesAnalysed += 100000;
@@ -134,12 +128,14 @@ void InvMassFit_PrepareData(Int_t iMassCut)
         }
 
         file->Write("",TObject::kWriteDelete);
+        file->Close();
+        StageCache_Update(name, key, "InvMassFit_PrepareData");
 
         return;
     }
 }
 
-void InvMassFit_DoFit(Int_t opt, Double_t fMCutLow, Double_t fMCutUpp, Double_t fAlpha_L, Double_t fAlpha_R, Double_t fN_L, Double_t fN_R, TString str_out, Bool_t isSystUncr = kFALSE, Double_t fCutZ = -1)
+void InvMassFit_DoFit(Int_t opt, Double_t fMCutLow, Double_t fMCutUpp, Double_t fAlpha_L, Double_t fAlpha_R, Double_t fN_L, Double_t fN_R, TString str_out, Bool_t isSystUncr = kFALSE)
 {
     // Fit the invariant mass distribution using Double-sided CB function
     // Fix the values of the tail parameters to MC values
@@ -221,14 +217,9 @@ void InvMassFit_DoFit(Int_t opt, Double_t fMCutLow, Double_t fMCutUpp, Double_t
     TFile *f_in = NULL;
     // ordinary fits:
     if(isSystUncr == kFALSE) f_in = new TFile("Trees/" + str_subfolder + "InvMassFit/InvMassFit.root"); 
-    // systematic uncertainties 
-    else 
-    {
-        // related to signal extraction
-        if(fCutZ == -1) f_in = new TFile("Trees/" + str_subfolder + "InvMassFit/InvMassFit_SystUncertainties.root"); 
-        // related to modifications of Z vertex cut 
-        else f_in = new TFile("Trees/" + str_subfolder + Form("VertexZ_SystUncertainty/Zcut%.1f_InvMassFit.root", fCutZ)); 
-    }
+    // systematic uncertainties related to signal extraction
+    // (variations of the cut on vertex Z are scanned by VertexZ_SystUncertainties.C without mass fits)
+    else f_in = new TFile("Trees/" + str_subfolder + "InvMassFit/InvMassFit_SystUncertainties.root"); 
 
     TTree *t_in = NULL;
     if(opt == 0 || opt == 3 || opt == 4 || opt == 5 || opt == 6 || opt == 7 || opt == 8){
@@ -431,10 +422,10 @@ void InvMassFit_DoFit(Int_t opt, Double_t fMCutLow, Double_t fMCutUpp, Double_t
     Printf("*** Results printed to %s.***", (str_out + "_bkg.txt").Data());
 
     // Print the plots
-    c1->Print((str_out + ".pdf").Data());
-    c1->Print((str_out + ".png").Data());
-    cCorrMat->Print((str_out + "_cm.pdf").Data());
-    cCorrMat->Print((str_out + "_cm.png").Data());    
+    PlotStore_Print(c1, str_out + ".pdf");
+    PlotStore_Print(c1, str_out + ".png");
+    PlotStore_Print(cCorrMat, str_out + "_cm.pdf");
+    PlotStore_Print(cCorrMat, str_out + "_cm.png");
 
     delete c1;
     delete cCorrMat;
@@ -494,20 +485,24 @@ void InvMassFit_DoFit(Int_t opt, Double_t fMCutLow, Double_t fMCutUpp, Double_t
         ltw->SetFillStyle(0);
         if(opt == 2 || opt > 3) ltw->Draw();
 
+        // paper figures: not from the systematic scans
+        Int_t paperMode = isSystUncr ? PlotStore_kSkip : PlotStore_kRender;
         if(preliminary == kTRUE && opt == 3) {
-            c2->Print("Results/" + str_subfolder + "_PreliminaryFigures/massFit.pdf");
-            c2->Print("Results/" + str_subfolder + "_PreliminaryFigures/massFit.eps");
+            PlotStore_Print(c2, "Results/" + str_subfolder + "_PreliminaryFigures/massFit.pdf", paperMode);
+            PlotStore_Print(c2, "Results/" + str_subfolder + "_PreliminaryFigures/massFit.eps", paperMode);
         } else if(preliminary == kFALSE && opt == 2) {
-            c2->Print("Results/" + str_subfolder + "_rozprava/massFit_all.pdf");
+            PlotStore_Print(c2, "Results/" + str_subfolder + "_rozprava/massFit_all.pdf", paperMode);
         } else if(preliminary == kFALSE && opt == 3) {
-            c2->Print("Results/" + str_subfolder + "_PaperFigures/massFit.pdf");
-            c2->Print("Results/" + str_subfolder + "_rozprava/massFit_allbins.pdf");
+            PlotStore_Print(c2, "Results/" + str_subfolder + "_PaperFigures/massFit.pdf", paperMode);
+            PlotStore_Print(c2, "Results/" + str_subfolder + "_rozprava/massFit_allbins.pdf", paperMode);
         } else if(preliminary == kFALSE && opt > 3) {
-            c2->Print("Results/" + str_subfolder + Form("_rozprava/massFit_%02i.pdf",opt-3));
+            PlotStore_Print(c2, "Results/" + str_subfolder + Form("_rozprava/massFit_%02i.pdf",opt-3), paperMode);
         }
         delete c2;
     }
     // ****************************************************************
 
     return;
-}
\ No newline at end of file
+}
+
+#endif
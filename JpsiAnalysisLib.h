@@ -0,0 +1,39 @@
+// JpsiAnalysisLib.h
+// David Grund, Oct 19, 2026
+// Version, families and content of the shared libraries with the common analysis code
+// (used by BuildJpsiAnalysisLib.C and LoadJpsiAnalysisLib.C, the source of the libraries is JpsiAnalysisLib.C)
+
+#ifndef JpsiAnalysisLib_h
+#define JpsiAnalysisLib_h
+
+// cpp headers
+#include <vector>
+// root headers
+#include "TString.h"
+
+// version of the API, increase it when a function or a global variable in the headers changes
+const Int_t JpsiAnalysisLib_version = 1;
+const Int_t JpsiAnalysisLib_nFamilies = 4;
+TString JpsiAnalysisLib_families[JpsiAnalysisLib_nFamilies] = {"Core", "InvMassFit", "PtFit", "CrossSec"};
+TString JpsiAnalysisLib_flags[JpsiAnalysisLib_nFamilies] = {"-DJPSI_LIB_CORE", "-DJPSI_LIB_INVMASSFIT", "-DJPSI_LIB_PTFIT", "-DJPSI_LIB_CROSSSEC"};
+
+TString JpsiAnalysisLib_Name(TString family, Int_t version = JpsiAnalysisLib_version)
+{
+    return Form("libJpsiAnalysis_%s_v%i", family.Data(), version);
+}
+
+// all headers compiled into the library of the family, also those included indirectly
+// (must be kept in sync with the includes of JpsiAnalysisLib.C)
+std::vector<TString> JpsiAnalysisLib_Headers(TString family)
+{
+    std::vector<TString> headers = {"ListsOfGoodRuns.h", "AnalysisManager.h", "AnalysisConfig.h", "SetPtBinning.h",
+        "StageCache.h", "Skim_Utilities.h", "DataCache.h", "MigrationMatrix.h", "RunCounters.h", "CutFlow.h",
+        "ReweightTable.h", "ModelStore.h", "PlotStore.h"};
+    if(family == "InvMassFit") headers.push_back("InvMassFit_Utilities.h");
+    if(family == "PtFit")    { headers.push_back("SetPtBinning_PtFit.h"); headers.push_back("PtFit_Utilities.h"); }
+    if(family == "CrossSec")   headers.push_back("CrossSec_Utilities.h");
+
+    return headers;
+}
+
+#endif
@@ -2,6 +2,9 @@
 // David Grund, Feb 27, 2022
 // Created in _CreateRunLists.h
 
+#ifndef ListsOfGoodRuns_h
+#define ListsOfGoodRuns_h
+
 // ************************************************************************************************
 // pass1 run lists
 
@@ -108,4 +111,6 @@ Int_t DPG_LHC18r_pass3_reduced[96] = {
     297311, 297317, 297332, 297333, 297335, 297336, 297363, 297366, 297367, 297372, 297379, 297380, 
     297405, 297406, 297413, 297414, 297415, 297441, 297442, 297446, 297450, 297451, 297452, 297479, 
     297481, 297483, 297512, 297537, 297540, 297541, 297542, 297544, 297558, 297588, 297590, 297595
-};
\ No newline at end of file
+};
+
+#endif
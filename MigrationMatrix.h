@@ -0,0 +1,130 @@
+// MigrationMatrix.h
+// David Grund, Oct 19, 2026
+// pT_rec vs pT_gen migration of the kIncohJpsiToMu MC, shared by ResolutionPt.C, MigrationPtRecGen.C
+// and Unfolding.C (one scan of the MC tree instead of one per macro)
+// The selected events (EventPassedMCRec(0,-1)) are stored once as columns: entry in the tree, pT_rec, pT_gen.
+// Each macro then bins them as it needs (pT bins, |t| bins, pT_rec - pT_gen, ...), which is the same
+// as rebinning an arbitrarily fine 2D matrix, but exact also for bin boundaries that do not lie
+// on a common grid and for quantities such as pT_rec - pT_gen.
+// The columns are recreated only if the MC or the selection changed (see StageCache.h).
+
+#ifndef MigrationMatrix_h
+#define MigrationMatrix_h
+
+// cpp headers
+#include <vector>
+#include <fstream>
+// root headers
+#include "TSystem.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TString.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+
+std::vector<Int_t> MigrationMatrix_entry;
+std::vector<Double_t> MigrationMatrix_ptRec;
+std::vector<Double_t> MigrationMatrix_ptGen;
+Int_t MigrationMatrix_nEntries = 0; // number of entries in the MC tree
+
+TString MigrationMatrix_FileName()
+{
+    return "Trees/" + str_subfolder + "MigrationMatrix/MC_kIncohJpsiToMu.cols";
+}
+
+Bool_t MigrationMatrix_Create(TString name)
+{
+    TFile *f = TFile::Open((str_in_MC_fldr_rec + "AnalysisResults_MC_kIncohJpsiToMu.root").Data(), "read");
+    if(!f) return kFALSE;
+    Printf("Input file %s loaded.", f->GetName());
+    TTree *t = dynamic_cast<TTree*> (f->Get(str_in_MC_tree_rec.Data()));
+    if(!t) return kFALSE;
+    Printf("Input tree %s loaded.", t->GetName());
+    ConnectTreeVariablesMCRec(t);
+
+    MigrationMatrix_entry.clear();
+    MigrationMatrix_ptRec.clear();
+    MigrationMatrix_ptGen.clear();
+    MigrationMatrix_nEntries = t->GetEntries();
+    Int_t nEntriesAnalysed = 0;
+    for(Int_t iEntry = 0; iEntry < MigrationMatrix_nEntries; iEntry++)
+    {
+        t->GetEntry(iEntry);
+        if(EventPassedMCRec(0,-1))
+        {
+            MigrationMatrix_entry.push_back(iEntry);
+            MigrationMatrix_ptRec.push_back(fPt);
+            MigrationMatrix_ptGen.push_back(fPtGen);
+        }
+        if((iEntry+1) % 100000 == 0){
+            nEntriesAnalysed += 100000;
+            Printf("%i entries analysed.", nEntriesAnalysed);
+        }
+    }
+    f->Close();
+
+    gSystem->Exec("mkdir -p Trees/" + str_subfolder + "MigrationMatrix/");
+    // written to a temporary file and renamed at the end, so that a file whose writing failed
+    // (disk full, process killed) is never taken for a valid cache
+    TString name_tmp = name + Form(".tmp%i", gSystem->GetPid());
+    Int_t nRows = MigrationMatrix_entry.size();
+    ofstream of(name_tmp.Data(), std::ios::binary);
+    of.write((char*)&MigrationMatrix_nEntries, sizeof(Int_t));
+    of.write((char*)&nRows, sizeof(Int_t));
+    of.write((char*)MigrationMatrix_entry.data(), nRows * sizeof(Int_t));
+    of.write((char*)MigrationMatrix_ptRec.data(), nRows * sizeof(Double_t));
+    of.write((char*)MigrationMatrix_ptGen.data(), nRows * sizeof(Double_t));
+    of.close();
+    if(!of.good() || gSystem->Rename(name_tmp.Data(), name.Data()) != 0)
+    {
+        Printf("Cannot write %s.", name.Data());
+        gSystem->Unlink(name_tmp.Data());
+        return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+Bool_t MigrationMatrix_Read(TString name)
+{
+    ifstream ifs(name.Data(), std::ios::binary);
+    Int_t nRows = 0;
+    ifs.read((char*)&MigrationMatrix_nEntries, sizeof(Int_t));
+    ifs.read((char*)&nRows, sizeof(Int_t));
+    if(ifs.fail() || nRows < 0 || nRows > MigrationMatrix_nEntries) return kFALSE;
+    MigrationMatrix_entry.resize(nRows);
+    MigrationMatrix_ptRec.resize(nRows);
+    MigrationMatrix_ptGen.resize(nRows);
+    ifs.read((char*)MigrationMatrix_entry.data(), nRows * sizeof(Int_t));
+    ifs.read((char*)MigrationMatrix_ptRec.data(), nRows * sizeof(Double_t));
+    ifs.read((char*)MigrationMatrix_ptGen.data(), nRows * sizeof(Double_t));
+    Bool_t ok = !ifs.fail();
+    ifs.close();
+
+    return ok;
+}
+
+Bool_t MigrationMatrix_Load()
+{
+    TString name = MigrationMatrix_FileName();
+    TString str_in = str_in_MC_fldr_rec + "AnalysisResults_MC_kIncohJpsiToMu.root";
+    TString key = StageCache_Key("MigrationMatrix", 1, {str_in, "MigrationMatrix.h", "AnalysisManager.h", "ListsOfGoodRuns.h"}, AnalysisConfig_ToString());
+    // a cache that cannot be read (e.g. truncated) is recreated
+    if(!StageCache_IsUpToDate(name, key) || !MigrationMatrix_Read(name))
+    {
+        if(!MigrationMatrix_Create(name)) return kFALSE;
+        StageCache_Update(name, key, "MigrationMatrix");
+    }
+    Printf("%i entries in the MC tree, %i of them pass the selection.", MigrationMatrix_nEntries, (Int_t)MigrationMatrix_entry.size());
+
+    return kTRUE;
+}
+
+Int_t MigrationMatrix_GetEntries()
+{
+    return MigrationMatrix_entry.size();
+}
+
+#endif
@@ -0,0 +1,449 @@
+// ModelStore.h
+// David Grund, Oct 19, 2026
+// Store of the model predictions of dsigma_gPb/d|t| (Trees/PhotoCrossSec)
+//  - each ASCII table is parsed and validated on its own, its row count is checked against the expected one
+//    (missing or incomplete rows => error, lines after the expected rows => warning, ignored as before),
+//    a broken table only affects the curves read from it
+//  - the curves of each table are cached in a binary file (Trees/<subfolder>/ModelStore/table<i>.bin),
+//    which is recreated only if the table changed (see StageCache.h)
+//  - each curve is interpolated either by a monotone cubic (Fritsch-Carlson, no overshoots between
+//    the nodes, default) or linearly in log(sigma) (ModelStore_SetInterpolation())
+//  - the integrals of sigma and |t|*sigma over a segment between two nodes are exact for both
+//    interpolations (Gauss-Legendre rule exact for the polynomial, closed form for the exponential),
+//    integrals over any |t| range are given by the cumulative integrals at the nodes
+//  - ModelStore_BinAverages() gives the bin averages and the mean |t| of all models in any binning
+// Curves 0-8 follow str_models in CrossSec_Utilities.h (in mb/GeV^2), curves 9-12 are the limits
+// of the GSZ bands: el+diss max, el+diss min, el max, el min.
+
+#ifndef ModelStore_h
+#define ModelStore_h
+
+// cpp headers
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm> // std::upper_bound()
+// root headers
+#include "TSystem.h"
+#include "TString.h"
+#include "TMath.h"
+// my headers
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+
+const Int_t ModelStore_nModels = 9;
+const Int_t ModelStore_nCurves = 13;
+const Int_t ModelStore_magic = 0x4D4F444C;
+
+std::vector<Double_t> ModelStore_t[ModelStore_nCurves];
+std::vector<Double_t> ModelStore_sig[ModelStore_nCurves];
+std::vector<Double_t> ModelStore_m[ModelStore_nCurves];    // derivatives of the monotone cubic at the nodes
+std::vector<Double_t> ModelStore_cum[ModelStore_nCurves];  // integral of sigma from the first node to the i-th one
+std::vector<Double_t> ModelStore_cumT[ModelStore_nCurves]; // the same for |t|*sigma
+// interpolation between the nodes
+const Int_t ModelStore_kMonotoneCubic = 0;
+const Int_t ModelStore_kLogLinear = 1;
+Int_t ModelStore_interp = ModelStore_kMonotoneCubic;
+
+// the tables: file, number of columns, expected number of rows
+const Int_t ModelStore_nTables = 7;
+TString ModelStore_tables[ModelStore_nTables] = {
+    "Trees/PhotoCrossSec/STARlight/IncJ_tDep_0.00-2.50.txt",
+    "Trees/PhotoCrossSec/HSModel/data-dtdy-y_0.6-Run1.txt",
+    "Trees/PhotoCrossSec/Heikki/ipsat_hight_alice_112021/no_photon_flux/incoherent_fluct",
+    "Trees/PhotoCrossSec/Heikki/ipsat_hight_alice_112021/no_photon_flux/incoherent_nofluct",
+    "Trees/PhotoCrossSec/Guzey/incoh_tdep_nuc_run2.dat",
+    "Trees/PhotoCrossSec/Heikki_new/cgc_with_shapefluct.txt",
+    "Trees/PhotoCrossSec/Heikki_new/cgc_no_shapefluct.txt"
+};
+Int_t ModelStore_nCols[ModelStore_nTables] = {2, 12, 2, 2, 7, 2, 2};
+Int_t ModelStore_nRows[ModelStore_nTables] = {125, 75, 183, 183, 100, 696, 696};
+// table from which each curve is read
+Int_t ModelStore_tableOfCurve[ModelStore_nCurves] = {0, 1, 1, 2, 3, 4, 4, 5, 6, 4, 4, 4, 4};
+Bool_t ModelStore_tableLoaded[ModelStore_nTables] = {kFALSE};
+
+TString ModelStore_FileName(Int_t iT)
+{
+    return "Trees/" + str_subfolder + Form("ModelStore/table%i.bin", iT);
+}
+
+// reads the first nRows rows of a table with nCols numeric columns to vals (row by row)
+// (empty lines are skipped, anything after the first nRows rows is ignored)
+Bool_t ModelStore_ReadTable(TString name, Int_t nCols, Int_t nRows, std::vector<Double_t> &vals)
+{
+    ifstream ifs(name.Data());
+    if(ifs.fail()) { Printf("Model table %s not found.", name.Data()); return kFALSE; }
+    vals.clear();
+    Int_t nRowsFound = 0;
+    Int_t nLinesIgnored = 0;
+    Int_t iLine = 0;
+    std::string line;
+    while(std::getline(ifs, line))
+    {
+        iLine++;
+        std::istringstream iss(line);
+        std::vector<Double_t> row;
+        Double_t x;
+        while(iss >> x) row.push_back(x);
+        Bool_t isNumeric = iss.eof();
+        if(isNumeric && row.empty()) continue;
+        if(nRowsFound == nRows) { nLinesIgnored++; continue; }
+        if(!isNumeric || (Int_t)row.size() != nCols)
+        {
+            Printf("Model table %s: line %i is not a row of %i numbers.", name.Data(), iLine, nCols);
+            return kFALSE;
+        }
+        vals.insert(vals.end(), row.begin(), row.end());
+        nRowsFound++;
+    }
+    ifs.close();
+    if(nRowsFound < nRows) { Printf("Model table %s: %i rows found, %i expected.", name.Data(), nRowsFound, nRows); return kFALSE; }
+    if(nLinesIgnored > 0) Printf("Warning: model table %s: %i lines after the first %i rows ignored.", name.Data(), nLinesIgnored, nRows);
+
+    return kTRUE;
+}
+
+// parses the table iT and fills the curves read from it
+Bool_t ModelStore_Ingest(Int_t iT)
+{
+    std::vector<Double_t> v;
+    if(!ModelStore_ReadTable(ModelStore_tables[iT], ModelStore_nCols[iT], ModelStore_nRows[iT], v)) return kFALSE;
+    for(Int_t iC = 0; iC < ModelStore_nCurves; iC++) {
+        if(ModelStore_tableOfCurve[iC] != iT) continue;
+        ModelStore_t[iC].clear();
+        ModelStore_sig[iC].clear();
+    }
+
+    for(Int_t i = 0; i < ModelStore_nRows[iT]; i++)
+    {
+        Double_t *r = &v[ModelStore_nCols[iT]*i];
+        switch(iT)
+        {
+            case 0: // STARlight (mb)
+                ModelStore_t[0].push_back(r[0]);
+                ModelStore_sig[0].push_back(r[1]);
+                break;
+            case 1: // CCK (mb): x, -, -, |t|, coh-n, err, inc-n, err, coh-hs, err, inc-hs, err
+                ModelStore_t[1].push_back(r[3]);
+                ModelStore_sig[1].push_back(r[10]); // CCK-hs
+                ModelStore_t[2].push_back(r[3]);
+                ModelStore_sig[2].push_back(r[6]);  // CCK-n
+                break;
+            case 2: // MS-hs (mb)
+                ModelStore_t[3].push_back(r[0]);
+                ModelStore_sig[3].push_back(r[1]);
+                break;
+            case 3: // MS-p (mb)
+                ModelStore_t[4].push_back(r[0]);
+                ModelStore_sig[4].push_back(r[1]);
+                break;
+            case 4: // GSZ (nb => mb): |t|, el min, el max, diss min, diss max, tot min, tot max
+            {
+                ModelStore_t[5].push_back(r[0]);
+                ModelStore_sig[5].push_back((r[6] + r[5]) / 2 / 1e6); // GSZ-el+diss
+                ModelStore_t[6].push_back(r[0]);
+                ModelStore_sig[6].push_back((r[2] + r[1]) / 2 / 1e6); // GSZ-el
+                Double_t band[4] = {r[6], r[5], r[2], r[1]};
+                for(Int_t j = 0; j < 4; j++) {
+                    ModelStore_t[9+j].push_back(r[0]);
+                    ModelStore_sig[9+j].push_back(band[j] / 1e6);
+                }
+                break;
+            }
+            case 5: // MSS-fl (mb)
+                ModelStore_t[7].push_back(r[0]);
+                ModelStore_sig[7].push_back(r[1]);
+                break;
+            case 6: // MSS (mb)
+                ModelStore_t[8].push_back(r[0]);
+                ModelStore_sig[8].push_back(r[1]);
+                break;
+        }
+    }
+
+    return kTRUE;
+}
+
+Bool_t ModelStore_Write(Int_t iT, TString name)
+{
+    // written to a temporary file first, so that a macro running in parallel never reads half of it
+    TString tmp = name + Form(".tmp%i", gSystem->GetPid());
+    ofstream of(tmp.Data(), std::ios::binary);
+    of.write((char*)&ModelStore_magic, sizeof(Int_t));
+    of.write((char*)&iT, sizeof(Int_t));
+    for(Int_t iC = 0; iC < ModelStore_nCurves; iC++) {
+        if(ModelStore_tableOfCurve[iC] != iT) continue;
+        Int_t n = ModelStore_t[iC].size();
+        of.write((char*)&n, sizeof(Int_t));
+        of.write((char*)ModelStore_t[iC].data(), n * sizeof(Double_t));
+        of.write((char*)ModelStore_sig[iC].data(), n * sizeof(Double_t));
+    }
+    of.close();
+    if(!of.good() || gSystem->Rename(tmp.Data(), name.Data()) != 0)
+    {
+        Printf("Cannot write %s.", name.Data());
+        gSystem->Unlink(tmp.Data());
+        return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+Bool_t ModelStore_Read(Int_t iT, TString name)
+{
+    ifstream ifs(name.Data(), std::ios::binary);
+    Int_t magic = 0, iTable = -1;
+    ifs.read((char*)&magic, sizeof(Int_t));
+    ifs.read((char*)&iTable, sizeof(Int_t));
+    if(ifs.fail() || magic != ModelStore_magic || iTable != iT) return kFALSE;
+    for(Int_t iC = 0; iC < ModelStore_nCurves; iC++) {
+        if(ModelStore_tableOfCurve[iC] != iT) continue;
+        Int_t n = 0;
+        ifs.read((char*)&n, sizeof(Int_t));
+        if(ifs.fail() || n < 2) return kFALSE;
+        ModelStore_t[iC].resize(n);
+        ModelStore_sig[iC].resize(n);
+        ifs.read((char*)ModelStore_t[iC].data(), n * sizeof(Double_t));
+        ifs.read((char*)ModelStore_sig[iC].data(), n * sizeof(Double_t));
+    }
+    Bool_t ok = !ifs.fail();
+    ifs.close();
+
+    return ok;
+}
+
+// derivatives of the monotone cubic (Fritsch-Carlson, as in PCHIP) and the integrals at the nodes
+void ModelStore_SegmentIntegrals(Int_t iC, Int_t i, Double_t a, Double_t b, Double_t &s0, Double_t &s1);
+void ModelStore_SetupInterpolation(Int_t iC)
+{
+    std::vector<Double_t> &x = ModelStore_t[iC];
+    std::vector<Double_t> &y = ModelStore_sig[iC];
+    std::vector<Double_t> &m = ModelStore_m[iC];
+    Int_t n = x.size();
+    m.assign(n, 0.);
+    for(Int_t i = 1; i < n; i++) if(!(x[i] > x[i-1])) Printf("Warning: |t| of the curve %i not increasing at node %i, segment skipped.", iC, i);
+    // slopes of the segments
+    std::vector<Double_t> h(n, 0.), d(n, 0.);
+    for(Int_t i = 0; i < n-1; i++) {
+        h[i] = x[i+1] - x[i];
+        d[i] = h[i] > 0 ? (y[i+1] - y[i]) / h[i] : 0.;
+    }
+    if(n == 2) m[0] = m[1] = d[0];
+    if(n > 2) {
+        // inner nodes: weighted harmonic mean of the neighbouring slopes, zero at extrema
+        for(Int_t i = 1; i < n-1; i++) {
+            if(d[i-1] * d[i] <= 0.) continue;
+            Double_t w1 = 2. * h[i] + h[i-1];
+            Double_t w2 = h[i] + 2. * h[i-1];
+            m[i] = (w1 + w2) / (w1 / d[i-1] + w2 / d[i]);
+        }
+        // end nodes: three-point formula, limited to keep the shape
+        Int_t iEnd[2] = {0, n-1};
+        for(Int_t k = 0; k < 2; k++) {
+            Int_t j0 = (k == 0) ? 0 : n-2; // the end segment
+            Int_t j1 = (k == 0) ? 1 : n-3; // its neighbour
+            Double_t mEnd = ((2. * h[j0] + h[j1]) * d[j0] - h[j0] * d[j1]) / (h[j0] + h[j1]);
+            if(mEnd * d[j0] <= 0.) mEnd = 0.;
+            else if(d[j0] * d[j1] <= 0. && TMath::Abs(mEnd) > 3. * TMath::Abs(d[j0])) mEnd = 3. * d[j0];
+            m[iEnd[k]] = mEnd;
+        }
+    }
+    // cumulative integrals
+    ModelStore_cum[iC].assign(n, 0.);
+    ModelStore_cumT[iC].assign(n, 0.);
+    for(Int_t i = 1; i < n; i++) {
+        Double_t s0(0.), s1(0.);
+        ModelStore_SegmentIntegrals(iC, i-1, x[i-1], x[i], s0, s1);
+        ModelStore_cum[iC][i] = ModelStore_cum[iC][i-1] + s0;
+        ModelStore_cumT[iC][i] = ModelStore_cumT[iC][i-1] + s1;
+    }
+
+    return;
+}
+
+// ModelStore_kMonotoneCubic or ModelStore_kLogLinear
+void ModelStore_SetInterpolation(Int_t interp)
+{
+    ModelStore_interp = interp;
+    for(Int_t iC = 0; iC < ModelStore_nCurves; iC++)
+        if(ModelStore_tableLoaded[ModelStore_tableOfCurve[iC]]) ModelStore_SetupInterpolation(iC);
+
+    return;
+}
+
+// loads the curves of the table iT (from the cache if the table did not change)
+Bool_t ModelStore_LoadTable(Int_t iT)
+{
+    if(ModelStore_tableLoaded[iT]) return kTRUE;
+    TString name = ModelStore_FileName(iT);
+    TString key = StageCache_Key("ModelStore", 2, {ModelStore_tables[iT], "ModelStore.h"}, Form("table=%i", iT));
+    if(!StageCache_IsUpToDate(name, key) || !ModelStore_Read(iT, name))
+    {
+        if(!ModelStore_Ingest(iT)) return kFALSE;
+        gSystem->Exec("mkdir -p Trees/" + str_subfolder + "ModelStore/");
+        // (if the cache cannot be written, the parsed table is used anyway)
+        if(ModelStore_Write(iT, name)) StageCache_Update(name, key, "ModelStore");
+        Printf("Model table %s parsed and cached in %s.", ModelStore_tables[iT].Data(), name.Data());
+    }
+    else Printf("Model curves of %s loaded from %s.", ModelStore_tables[iT].Data(), name.Data());
+    for(Int_t iC = 0; iC < ModelStore_nCurves; iC++)
+        if(ModelStore_tableOfCurve[iC] == iT) ModelStore_SetupInterpolation(iC);
+    ModelStore_tableLoaded[iT] = kTRUE;
+
+    return kTRUE;
+}
+
+// iC >= 0: loads the table of the curve iC
+// iC = -1: loads all tables, kFALSE if one of them cannot be loaded (the others are loaded anyway)
+Bool_t ModelStore_Load(Int_t iC = -1)
+{
+    if(iC >= 0) return ModelStore_LoadTable(ModelStore_tableOfCurve[iC]);
+    Bool_t ok = kTRUE;
+    for(Int_t iT = 0; iT < ModelStore_nTables; iT++) if(!ModelStore_LoadTable(iT)) ok = kFALSE;
+
+    return ok;
+}
+
+Bool_t ModelStore_IsLoaded(Int_t iC)
+{
+    return ModelStore_tableLoaded[ModelStore_tableOfCurve[iC]];
+}
+
+Int_t ModelStore_GetN(Int_t iC)
+{
+    return ModelStore_t[iC].size();
+}
+
+// index of the segment [t_i, t_i+1] containing t (clamped to the range of the curve)
+Int_t ModelStore_Segment(Int_t iC, Double_t t)
+{
+    std::vector<Double_t> &x = ModelStore_t[iC];
+    Int_t i = std::upper_bound(x.begin(), x.end(), t) - x.begin() - 1;
+    if(i < 0) i = 0;
+    if(i > (Int_t)x.size()-2) i = x.size()-2;
+
+    return i;
+}
+
+// value of the interpolation at t within the segment i
+Double_t ModelStore_EvalSegment(Int_t iC, Int_t i, Double_t t)
+{
+    std::vector<Double_t> &x = ModelStore_t[iC];
+    std::vector<Double_t> &y = ModelStore_sig[iC];
+    Double_t h = x[i+1] - x[i];
+    if(!(h > 0.)) return y[i];
+    if(ModelStore_interp == ModelStore_kLogLinear && y[i] > 0. && y[i+1] > 0.)
+        return y[i] * TMath::Exp(TMath::Log(y[i+1] / y[i]) * (t - x[i]) / h);
+    if(ModelStore_interp == ModelStore_kLogLinear) return y[i] + (y[i+1] - y[i]) * (t - x[i]) / h; // sigma <= 0 => linear
+    // Hermite cubic
+    std::vector<Double_t> &m = ModelStore_m[iC];
+    Double_t s = (t - x[i]) / h;
+    Double_t s2 = s*s;
+    Double_t s3 = s2*s;
+    return (2.*s3 - 3.*s2 + 1.) * y[i] + (s3 - 2.*s2 + s) * h * m[i] + (-2.*s3 + 3.*s2) * y[i+1] + (s3 - s2) * h * m[i+1];
+}
+
+// value of the interpolation at t (t within the range of the curve)
+Double_t ModelStore_Eval(Int_t iC, Double_t t)
+{
+    return ModelStore_EvalSegment(iC, ModelStore_Segment(iC, t), t);
+}
+
+// integrals of sigma (s0) and |t|*sigma (s1) over (a, b) inside the segment i
+void ModelStore_SegmentIntegrals(Int_t iC, Int_t i, Double_t a, Double_t b, Double_t &s0, Double_t &s1)
+{
+    s0 = 0.; s1 = 0.;
+    if(!(b > a)) return;
+    std::vector<Double_t> &x = ModelStore_t[iC];
+    std::vector<Double_t> &y = ModelStore_sig[iC];
+    Double_t h = x[i+1] - x[i];
+    if(!(h > 0.)) return;
+    if(ModelStore_interp == ModelStore_kLogLinear && y[i] > 0. && y[i+1] > 0.)
+    {
+        // sigma = sig_a * exp(k*(t-a))
+        Double_t k = TMath::Log(y[i+1] / y[i]) / h;
+        Double_t w = b - a;
+        if(TMath::Abs(k * w) > 0.1)
+        {
+            Double_t sig_a = ModelStore_EvalSegment(iC, i, a);
+            Double_t sig_b = ModelStore_EvalSegment(iC, i, b);
+            s0 = (sig_b - sig_a) / k;
+            s1 = (b * sig_b - a * sig_a) / k - s0 / k;
+            return;
+        }
+        // nearly constant: the Gauss-Legendre rule below is exact to ~1e-10
+    }
+    // 3-point Gauss-Legendre: exact for |t|*cubic (degree 4 <= 5)
+    const Double_t gx[3] = {-0.774596669241483377, 0., 0.774596669241483377};
+    const Double_t gw[3] = {5./9., 8./9., 5./9.};
+    Double_t c = (a + b) / 2.;
+    Double_t r = (b - a) / 2.;
+    for(Int_t j = 0; j < 3; j++) {
+        Double_t t = c + r * gx[j];
+        Double_t sig = ModelStore_EvalSegment(iC, i, t);
+        s0 += r * gw[j] * sig;
+        s1 += r * gw[j] * sig * t;
+    }
+
+    return;
+}
+
+// integrals of sigma (p0) and |t|*sigma (p1) from the first node up to t (t clamped to the range of the curve)
+void ModelStore_Primitives(Int_t iC, Double_t t, Double_t &p0, Double_t &p1)
+{
+    std::vector<Double_t> &x = ModelStore_t[iC];
+    if(t <= x.front()) { p0 = 0.; p1 = 0.; return; }
+    if(t >= x.back()) { p0 = ModelStore_cum[iC].back(); p1 = ModelStore_cumT[iC].back(); return; }
+    Int_t i = ModelStore_Segment(iC, t);
+    Double_t s0(0.), s1(0.);
+    ModelStore_SegmentIntegrals(iC, i, x[i], t, s0, s1);
+    p0 = ModelStore_cum[iC][i] + s0;
+    p1 = ModelStore_cumT[iC][i] + s1;
+
+    return;
+}
+
+// integral of the curve iC over (t_low, t_upp) (in mb if the curve is in mb/GeV^2)
+Double_t ModelStore_Integral(Int_t iC, Double_t t_low, Double_t t_upp)
+{
+    Double_t p0_low(0.), p1_low(0.), p0_upp(0.), p1_upp(0.);
+    ModelStore_Primitives(iC, t_low, p0_low, p1_low);
+    ModelStore_Primitives(iC, t_upp, p0_upp, p1_upp);
+
+    return p0_upp - p0_low;
+}
+
+// bin averages of sigma (avg) and mean |t| (avgt) of the curves 0 to nC-1 in the binning given by edges[nBins+1]
+// (bins outside the range of a curve are integrated only over the overlap, a warning is printed;
+//  curves that are not loaded get zeros)
+void ModelStore_BinAverages(Int_t nBins, const Double_t *edges, std::vector<Double_t> *avg, std::vector<Double_t> *avgt, Int_t nC = ModelStore_nModels)
+{
+    std::vector<Double_t> p0(nBins+1), p1(nBins+1);
+    for(Int_t iC = 0; iC < nC; iC++)
+    {
+        if(!ModelStore_IsLoaded(iC))
+        {
+            Printf("Warning: curve %i not loaded, its bin averages set to zero.", iC);
+            avg[iC].assign(nBins, 0.);
+            avgt[iC].assign(nBins, 0.);
+            continue;
+        }
+        if(edges[0] < ModelStore_t[iC].front() || edges[nBins] > ModelStore_t[iC].back())
+            Printf("Warning: binning (%.3f,%.3f) exceeds the range of the curve %i (%.3f,%.3f).", 
+                edges[0], edges[nBins], iC, ModelStore_t[iC].front(), ModelStore_t[iC].back());
+        for(Int_t iEdge = 0; iEdge <= nBins; iEdge++) ModelStore_Primitives(iC, edges[iEdge], p0[iEdge], p1[iEdge]);
+        avg[iC].resize(nBins);
+        avgt[iC].resize(nBins);
+        for(Int_t iBin = 0; iBin < nBins; iBin++)
+        {
+            Double_t integral = p0[iBin+1] - p0[iBin];
+            avg[iC][iBin] = integral / (edges[iBin+1] - edges[iBin]);
+            avgt[iC][iBin] = integral != 0. ? (p1[iBin+1] - p1[iBin]) / integral : (edges[iBin] + edges[iBin+1]) / 2.;
+        }
+    }
+
+    return;
+}
+
+#endif
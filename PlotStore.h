@@ -0,0 +1,125 @@
+// PlotStore.h
+// David Grund, Oct 19, 2026
+// Plots decoupled from the computation:
+// PlotStore_Print(c, path) replaces c->Print(path). Depending on the environment variable PLOTSTORE_MODE it
+//  - "render" (default): prints the canvas right away, as before
+//  - "store": writes the canvas (frames, histograms, graphs, fit curves, legends) and the list of
+//    requested formats to Trees/<subfolder>/PlotStore/<path>.root, the figures are then printed
+//    by RenderPlots.C in parallel batch-mode processes (RunPipeline.sh does it after the last stage)
+//  - "skip": does nothing
+// The stored canvases stay in the store: the figures can be printed again without recomputing
+// (RunPipeline.sh only renders the plots stored during its run).
+// A path without an extension is printed as pdf.
+
+#ifndef PlotStore_h
+#define PlotStore_h
+
+// cpp headers
+#include <map>
+// root headers
+#include "TSystem.h"
+#include "TFile.h"
+#include "TCanvas.h"
+#include "TNamed.h"
+#include "TString.h"
+#include "TObjString.h"
+#include "TObjArray.h"
+#include "TMath.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+
+const Int_t PlotStore_kRender = 0;
+const Int_t PlotStore_kStore = 1;
+const Int_t PlotStore_kSkip = 2;
+std::map<TString, TString> PlotStore_formats; // formats requested for each stored plot (in this process)
+
+Int_t PlotStore_Mode()
+{
+    TString mode = gSystem->Getenv("PLOTSTORE_MODE");
+    if(mode == "store") return PlotStore_kStore;
+    if(mode == "skip")  return PlotStore_kSkip;
+    return PlotStore_kRender;
+}
+
+// file of the store corresponding to the output path (without the extension)
+TString PlotStore_FileName(TString path_noext)
+{
+    TString rel = path_noext;
+    TString prefix = "Results/" + str_subfolder;
+    if(rel.BeginsWith(prefix)) rel.Remove(0, prefix.Length());
+
+    return "Trees/" + str_subfolder + "PlotStore/" + rel + ".root";
+}
+
+// minMode: the plot is at least stored (PlotStore_kStore) or skipped (PlotStore_kSkip), whatever PLOTSTORE_MODE says
+void PlotStore_Print(TCanvas *c, TString path, Int_t minMode = PlotStore_kRender)
+{
+    Int_t mode = TMath::Max(PlotStore_Mode(), minMode);
+    if(mode == PlotStore_kSkip) return;
+    if(path.Last('.') <= path.Last('/')) {
+        Printf("PlotStore: %s has no extension, printed as pdf.", path.Data());
+        path += ".pdf";
+    }
+    if(mode == PlotStore_kRender) { c->Print(path.Data()); return; }
+
+    Int_t iDot = path.Last('.');
+    TString path_noext = path(0, iDot);
+    TString format = path(iDot+1, path.Length());
+    TString &formats = PlotStore_formats[path_noext];
+    if(!(" " + formats + " ").Contains(" " + format + " ")) formats += (formats.Length() > 0 ? " " : "") + format;
+
+    TString name = PlotStore_FileName(path_noext);
+    gSystem->Exec("mkdir -p " + TString(gSystem->DirName(name.Data())));
+    // written to a temporary file and renamed at the end, so that RenderPlots.C never reads half of it
+    TString name_tmp = name + Form(".tmp%i", gSystem->GetPid());
+    TDirectory *dir = gDirectory;
+    TFile *f = new TFile(name_tmp.Data(), "RECREATE");
+    Bool_t ok = !f->IsZombie();
+    if(ok)
+    {
+        ok = (c->Write("canvas") > 0);
+        TNamed spec("spec", path_noext.Data());
+        spec.SetTitle(formats.Data());
+        ok = (spec.Write() > 0) && ok;
+        f->Close();
+    }
+    delete f;
+    dir->cd();
+    if(!ok || gSystem->Rename(name_tmp.Data(), name.Data()) != 0)
+    {
+        Printf("PlotStore: %s cannot be stored.", path.Data());
+        gSystem->Unlink(name_tmp.Data());
+    }
+
+    return;
+}
+
+// prints the figures of one stored plot, returns the number of printed files
+Int_t PlotStore_Render(TString name)
+{
+    TFile *f = TFile::Open(name.Data(), "read");
+    if(!f) return 0;
+    TCanvas *c = dynamic_cast<TCanvas*> (f->Get("canvas"));
+    TNamed *spec = dynamic_cast<TNamed*> (f->Get("spec"));
+    Int_t nPrinted = 0;
+    if(c && spec)
+    {
+        TString path_noext = spec->GetName();
+        gSystem->Exec("mkdir -p " + TString(gSystem->DirName(path_noext.Data())));
+        TString formats = spec->GetTitle();
+        TObjArray *arr = formats.Tokenize(" ");
+        for(Int_t i = 0; i < arr->GetEntries(); i++) {
+            c->Print((path_noext + "." + ((TObjString*)arr->At(i))->GetString()).Data());
+            nPrinted++;
+        }
+        delete arr;
+    }
+    else Printf("File %s does not contain a stored plot.", name.Data());
+    f->Close();
+    delete f;
+
+    return nPrinted;
+}
+
+#endif
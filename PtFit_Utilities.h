@@ -1,9 +1,13 @@
 // PtFit_Utilities.h
 // David Grund, June 21, 2022
 
+#ifndef PtFit_Utilities_h
+#define PtFit_Utilities_h
+
 // cpp headers
 #include <fstream>
 #include <iomanip> // std::setprecision()
+#include <algorithm> // std::upper_bound
 // root headers
 #include "TSystem.h"
 #include "TFile.h"
@@ -30,6 +34,7 @@
 #include "AnalysisConfig.h"
 #include "SetPtBinning_PtFit.h"
 #include "SetPtBinning.h"
+#include "PlotStore.h"
 
 using namespace RooFit;
 
@@ -164,45 +169,103 @@ void PtFit_SetCanvas(TCanvas *c, Bool_t isLogScale)
 
 // #############################################################################################
 
+// Table of fD_coh and fD_inc (in percent) vs. R, see PtFit_FeedDownNormalization.C
+// (read only once, then any value of R within the table range can be used)
+vector<Double_t> fD_table_R;
+vector<Double_t> fD_table_coh;
+vector<Double_t> fD_table_inc;
+
+Bool_t PtFit_LoadFeedDownTable()
+{
+    if(fD_table_R.size() > 0) return kTRUE;
+
+    ifstream ifs;
+    ifs.open(("Results/" + str_subfolder + "PtFit_FeedDownNormalization/fD_vs_R.txt").Data());
+    if(ifs.fail())
+    {
+        Printf("Table of fD coefficients missing. Terminating...");
+        return kFALSE;
+    }
+    Int_t i = 0;
+    std::string str;
+    while(std::getline(ifs,str)){
+        istringstream in_stream(str);
+        Double_t R, fDCoh, fDCoh_err, fDInc, fDInc_err;
+        // skip first line
+        if(i > 0 && in_stream >> R >> fDCoh >> fDCoh_err >> fDInc >> fDInc_err)
+        {
+            fD_table_R.push_back(R);
+            fD_table_coh.push_back(fDCoh);
+            fD_table_inc.push_back(fDInc);
+        }
+        i++;
+    }
+    ifs.close();
+    if(fD_table_R.size() == 0)
+    {
+        Printf("Table of fD coefficients empty. Terminating...");
+        return kFALSE;
+    }
+    Printf("Table of fD coefficients loaded (%i values of R).", (Int_t)fD_table_R.size());
+
+    return kTRUE;
+}
+
+Double_t PtFit_InterpolateFeedDown(Double_t R, vector<Double_t> &fD_table)
+{
+    // linear interpolation between the neighbouring grid points
+    Int_t n = fD_table_R.size();
+    if(R <= fD_table_R[0])   return fD_table[0];
+    if(R >= fD_table_R[n-1]) return fD_table[n-1];
+    Int_t i = std::upper_bound(fD_table_R.begin(), fD_table_R.end(), R) - fD_table_R.begin();
+    Double_t w = (R - fD_table_R[i-1]) / (fD_table_R[i] - fD_table_R[i-1]);
+
+    return (1 - w) * fD_table[i-1] + w * fD_table[i];
+}
+
+// #############################################################################################
+
 void PtFit_NoBkg_DoFit(Int_t iRecShape, Int_t iDiss = 5, Int_t ifD = 0)
 // ifD = 0 => R_coh = R_inc = R = 0.18 (Michal's measured value)
-// systematic uncertainties:
+// discrete variations of R (the systematic uncertainties use the continuous scan below):
 //     = -2 => R = 0.16
 //     = -1 => R = 0.17
 //     = 1 => R = 0.19
 //     = 2 => R = 0.20
 //     = 10 => test for Guillermo (July 2023): R_coh = 0.18; R_inc = 0.21
 //     = 11 => test for Guillermo (July 2023): R_coh = 0.18; R_inc = 0.23
+// continuous scan of R (any value covered by the table fD_vs_R.txt):
+//     = 100 to 300 => R = ifD / 1000 (e.g. 175 => R = 0.175)
+// (other values are rejected)
 {
     Printf("###########################################");
     // ratio of the coherent psi(2S) and J/psi cross sections
     // needed to fix the normalizations of feed-down curves
     // (the ratio of incoherent cross sections is fixed to the same value)
-    Double_t R = 0.18 + ifD * 0.01;
-    Printf("Ratio of the cross sections: R = %.2f", R);
+    Double_t R = 0.18;
+    if(ifD >= -2 && ifD <= 2)          R = 0.18 + ifD * 0.01;
+    else if(ifD >= 100 && ifD <= 300)  R = ifD / 1000.;
+    else if(ifD != 10 && ifD != 11) {
+        Printf("Value of ifD = %i not supported. Terminating...", ifD);
+        return;
+    }
+    Printf("Ratio of the cross sections: R = %.3f", R);
+
+    // ratios used for the coherent and incoherent feed-down
+    Double_t R_coh = R;
+    Double_t R_inc = R;
+    if(ifD == 10) R_inc = 0.21;
+    if(ifD == 11) R_inc = 0.23;
 
-    // Load the values of fD coefficients
+    // Load the values of fD coefficients from the table fD(R)
     Double_t fDCoh, fDInc;
-    ifstream ifs;
-    if(ifD < 10) ifs.open(Form("Results/%sPtFit_FeedDownNormalization/fD_only_R_coh%.3f_R_inc%.3f.txt", str_subfolder.Data(), R, R));
-    else if(ifD == 10) ifs.open(Form("Results/%sPtFit_FeedDownNormalization/fD_only_R_coh0.180_R_inc0.210.txt", str_subfolder.Data()));
-    else if(ifD == 11) ifs.open(Form("Results/%sPtFit_FeedDownNormalization/fD_only_R_coh0.180_R_inc0.230.txt", str_subfolder.Data()));
-    if(!ifs.fail())
-    {
-        // Read data from the file
-        Int_t i = 0;
-        std::string str;
-        while(std::getline(ifs,str)){
-            istringstream in_stream(str);
-            // skip first line
-            if(i == 1) in_stream >> fDCoh >> fDInc;
-            i++;   
-        } 
-        ifs.close();
-    } else {
-        Printf("fD coefficients missing. Terminating...");
+    if(!PtFit_LoadFeedDownTable()) return;
+    if(TMath::Min(R_coh, R_inc) < fD_table_R.front() || TMath::Max(R_coh, R_inc) > fD_table_R.back()) {
+        Printf("R outside the table of fD coefficients (%.3f to %.3f). Terminating...", fD_table_R.front(), fD_table_R.back());
         return;
     }
+    fDCoh = PtFit_InterpolateFeedDown(R_coh, fD_table_coh);
+    fDInc = PtFit_InterpolateFeedDown(R_inc, fD_table_inc);
     // from percent to decimal number
     fDCoh = fDCoh / 100.;
     fDInc = fDInc / 100.;
@@ -1037,9 +1100,9 @@ void PtFit_NoBkg_DoFit(Int_t iRecShape, Int_t iDiss = 5, Int_t ifD = 0)
     l2->Draw();
 
     // Print the results to pdf and png
-    cCM->Print((name + "_CM.pdf").Data());
-    cPt->Print((name + ".pdf").Data());
-    cPtLog->Print((name + "_log.pdf").Data());
+    PlotStore_Print(cCM, name + "_CM.pdf");
+    PlotStore_Print(cPt, name + ".pdf");
+    PlotStore_Print(cPtLog, name + "_log.pdf");
     //if(iRecShape == 4) cPt2Log->Print((name + "_log_vsPt2.pdf").Data());
     // If we study the optimal value of R_A, print chi2 vs. R_A to a text file
     if(iRecShape > 1000){
@@ -1066,6 +1129,9 @@ void PtFit_NoBkg_DoFit(Int_t iRecShape, Int_t iDiss = 5, Int_t ifD = 0)
     bool logScale = true;
     bool showChi2 = true;
     bool preliminary = false;
+    // paper figures: not from the systematic scans and the R_A scan
+    Bool_t isScan = (iDiss != 5 || ifD != 0 || iRecShape > 1000);
+    Int_t paperMode = isScan ? PlotStore_kSkip : PlotStore_kRender;
     
     if(fitOld == true || fitNew == true)
     {
@@ -1139,18 +1205,18 @@ void PtFit_NoBkg_DoFit(Int_t iRecShape, Int_t iDiss = 5, Int_t ifD = 0)
         if(showChi2) ltw->Draw();
 
         if(preliminary) {
-            cPaper->Print("Results/" + str_subfolder + "_PreliminaryFigures/ptFit.pdf");
-            cPaper->Print("Results/" + str_subfolder + "_PreliminaryFigures/ptFit.eps");
+            PlotStore_Print(cPaper, "Results/" + str_subfolder + "_PreliminaryFigures/ptFit.pdf", paperMode);
+            PlotStore_Print(cPaper, "Results/" + str_subfolder + "_PreliminaryFigures/ptFit.eps", paperMode);
         } else if(fitNew == true && showChi2 == false) {
-            cPaper->Print("Results/" + str_subfolder + "_PaperFigures/ptFit.pdf");
+            PlotStore_Print(cPaper, "Results/" + str_subfolder + "_PaperFigures/ptFit.pdf", paperMode);
         } else if(showChi2 == true) {
             if(fitOld) {
-                if(logScale) cPaper->Print("Results/" + str_subfolder + "_rozprava/ptFit_old_log.pdf");
-                else         cPaper->Print("Results/" + str_subfolder + "_rozprava/ptFit_old.pdf");
+                if(logScale) PlotStore_Print(cPaper, "Results/" + str_subfolder + "_rozprava/ptFit_old_log.pdf", paperMode);
+                else         PlotStore_Print(cPaper, "Results/" + str_subfolder + "_rozprava/ptFit_old.pdf", paperMode);
             }
             if(fitNew) {
-                if(logScale) cPaper->Print("Results/" + str_subfolder + "_rozprava/ptFit_new_log.pdf");
-                else         cPaper->Print("Results/" + str_subfolder + "_rozprava/ptFit_new.pdf");
+                if(logScale) PlotStore_Print(cPaper, "Results/" + str_subfolder + "_rozprava/ptFit_new_log.pdf", paperMode);
+                else         PlotStore_Print(cPaper, "Results/" + str_subfolder + "_rozprava/ptFit_new.pdf", paperMode);
             }
         }
         delete cPaper;
@@ -1315,27 +1381,29 @@ void PtFit_NoBkg_DoFit(Int_t iRecShape, Int_t iDiss = 5, Int_t ifD = 0)
         // print the results
         if(fitOld) {
             if(logScale) { 
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_old_root_log.pdf");
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_old_root_log.C");
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_old_root_log.pdf", paperMode);
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_old_root_log.C", paperMode);
             } else {
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_old_root.pdf");
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_old_root.C");
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_old_root.pdf", paperMode);
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_old_root.C", paperMode);
             }        
-            cRat->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_old_ratios.pdf");
+            PlotStore_Print(cRat, "Results/" + str_subfolder + "_PaperFigures/ptFit_old_ratios.pdf", paperMode);
         }
         if(fitNew) {
             if(logScale) {
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_new_root_log.pdf");
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_new_root_log.C");
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_new_root_log.pdf", paperMode);
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_new_root_log.C", paperMode);
             } else {
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_new_root.pdf");
-                cRoot->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_new_root.C");
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_new_root.pdf", paperMode);
+                PlotStore_Print(cRoot, "Results/" + str_subfolder + "_PaperFigures/ptFit_new_root.C", paperMode);
             }         
-            cRat->Print("Results/" + str_subfolder + "_PaperFigures/ptFit_new_ratios.pdf");
+            PlotStore_Print(cRat, "Results/" + str_subfolder + "_PaperFigures/ptFit_new_ratios.pdf", paperMode);
         }
         delete cRoot;
         delete cRat;
     }
 
     return;
-}
\ No newline at end of file
+}
+
+#endif
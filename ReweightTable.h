@@ -0,0 +1,77 @@
+// ReweightTable.h
+// David Grund, Oct 19, 2026
+// Lookup table with the weights of an MC re-weighting (e.g. ratio of the new and old pT_gen spectra)
+// Weight(x) gives the same value as h->GetBinContent(h->GetXaxis()->FindBin(x)), including the underflow
+// and the overflow, but without the calls to TAxis/TH1 and without branches:
+//  - uniform binning: the bin is calculated as in TAxis::FindFixBin and clamped to [0, nBins+1]
+//  - variable binning: binary search with a fixed number of steps (edges padded to a power of two)
+
+#ifndef ReweightTable_h
+#define ReweightTable_h
+
+// cpp headers
+#include <vector>
+#include <cmath>
+#include <limits>
+// root headers
+#include "TH1.h"
+#include "TAxis.h"
+
+class ReweightTable
+{
+    public:
+        ReweightTable(TH1 *h);
+        ~ReweightTable() {}
+        Double_t Weight(Double_t x) const {return fW[Bin(x)];}
+        Int_t    GetNbins() const {return fN;}
+    private:
+        Int_t    Bin(Double_t x) const;
+        Int_t    fN;
+        Bool_t   fUniform;
+        Double_t fLow;
+        Double_t fUpp;
+        Int_t    fNSteps;               // number of steps of the binary search
+        std::vector<Double_t> fEdges;   // fN+1 edges, padded with +inf
+        std::vector<Double_t> fW;       // underflow, bins 1 to fN, overflow
+};
+
+ReweightTable::ReweightTable(TH1 *h)
+{
+    TAxis *axis = h->GetXaxis();
+    fN = axis->GetNbins();
+    fUniform = (axis->GetXbins()->GetSize() == 0);
+    fLow = axis->GetXmin();
+    fUpp = axis->GetXmax();
+
+    fW.resize(fN+2);
+    for(Int_t iBin = 0; iBin <= fN+1; iBin++) fW[iBin] = h->GetBinContent(iBin);
+
+    fNSteps = 0;
+    while((1 << fNSteps) < fN+1) fNSteps++;
+    fEdges.assign(1 << fNSteps, std::numeric_limits<Double_t>::infinity());
+    for(Int_t iBin = 1; iBin <= fN+1; iBin++) fEdges[iBin-1] = axis->GetBinLowEdge(iBin);
+}
+
+Int_t ReweightTable::Bin(Double_t x) const
+{
+    if(fUniform)
+    {
+        // same arithmetics as TAxis::FindFixBin, x >= fUpp and NaN => overflow, x < fLow => underflow
+        Double_t t = fN * (x - fLow) / (fUpp - fLow);
+        t = (t < fN) ? t : fN;
+        t = (t > -1.) ? t : -1.;
+        return 1 + (Int_t)std::floor(t);
+    }
+    else
+    {
+        // number of edges <= x (= TMath::BinarySearch + 1, as in TAxis::FindBin)
+        Int_t i = 0;
+        for(Int_t step = (1 << fNSteps) >> 1; step > 0; step >>= 1) i += (fEdges[i + step - 1] <= x) ? step : 0;
+        i += (fEdges[i] <= x) ? 1 : 0;
+        // x = +inf also counts the padding => clamped to the overflow
+        i = (i < fN+1) ? i : fN+1;
+        return (x == x) ? i : fN+1;
+    }
+}
+
+#endif
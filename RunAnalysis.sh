@@ -2,11 +2,24 @@
 #!/bin/bash
 # to run it do (inside ali shell):
 # ./RunAnalysis.sh
+# (to run the independent macros in parallel, use ./RunPipeline.sh instead)
 
 # define the type of the analysis (see AnalysisConfig.h)
 declare -i iAnalysis=3
 # define if compile each macro
 declare -i compile=0
+# interpreted macros are run with the library of the common code, if it was built (see BuildJpsiAnalysisLib.C):
+# prints the argument of root that loads the library needed by the macro, e.g. LoadJpsiAnalysisLib.C("PtFit")
+LoadLib()
+{
+    local family="Core"
+    if   grep -q '#include "InvMassFit_Utilities.h"' "$1"; then family="InvMassFit"
+    elif grep -q '#include "PtFit_Utilities.h"' "$1"; then family="PtFit"
+    elif grep -q '#include "CrossSec_Utilities.h"' "$1"; then family="CrossSec"
+    elif ! grep -q '#include "AnalysisManager.h"' "$1"; then return
+    fi
+    ls lib/libJpsiAnalysis_${family}_v*.so > /dev/null 2>&1 && echo "LoadJpsiAnalysisLib.C(\"$family\")"
+}
 # define which macros to run
 declare -a arr=("0" "1" "2" "3" "4" "5" "6" "7" "8" "9y" "10")
 #declare -a arr=("0" "1" "2" "3" "4" "5" "6" "7" "8" "9" "10")
@@ -17,9 +30,9 @@ if [ "${arr[1]}" = "1y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q CountEvents.C\($iAnalysis\)
-        root -q CountEvents_MC.C\($iAnalysis\)
-        root -q RunListCheck.C\($iAnalysis\)
+        root -q $(LoadLib CountEvents.C) CountEvents.C\($iAnalysis\)
+        root -q $(LoadLib CountEvents_MC.C) CountEvents_MC.C\($iAnalysis\)
+        root -q $(LoadLib RunListCheck.C) RunListCheck.C\($iAnalysis\)
     else 
         root -q CountEvents.C+\($iAnalysis\)
         root -q CountEvents_MC.C+\($iAnalysis\)
@@ -29,15 +42,18 @@ fi
 
 # 2) Integrated luminosity:
 #    - get trigger counters for both periods
+#    - create the index of the trending file (needs AliRoot)
 #    - calculate the lumi
 if [ "${arr[2]}" = "2y" ] 
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q GetTriggerCounters.C\($iAnalysis\)
-        root -q IntegratedLuminosity.C\($iAnalysis\)
+        root -q $(LoadLib GetTriggerCounters.C) GetTriggerCounters.C\($iAnalysis\)
+        root -q CreateLumiIndex.C
+        root -q $(LoadLib IntegratedLuminosity.C) IntegratedLuminosity.C\($iAnalysis\)
     else 
         root -q GetTriggerCounters.C+\($iAnalysis\)
+        root -q CreateLumiIndex.C+
         root -q IntegratedLuminosity.C+\($iAnalysis\)
     fi
 fi
@@ -49,8 +65,8 @@ if [ "${arr[3]}" = "3y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q InvMassFit_MC.C\($iAnalysis,0\)
-        root -q InvMassFit.C\($iAnalysis,0\)
+        root -q $(LoadLib InvMassFit_MC.C) InvMassFit_MC.C\($iAnalysis,0\)
+        root -q $(LoadLib InvMassFit.C) InvMassFit.C\($iAnalysis,0\)
     else 
         root -q InvMassFit_MC.C+\($iAnalysis,0\)
         root -q InvMassFit.C+\($iAnalysis,0\)
@@ -61,7 +77,7 @@ fi
 if [ "${arr[4]}" = "4y" ] 
 then
     if [[ "$compile" -eq 0 ]]
-    then root -q BinsThroughMassFit.C\($iAnalysis\)
+    then root -q $(LoadLib BinsThroughMassFit.C) BinsThroughMassFit.C\($iAnalysis\)
     else root -q BinsThroughMassFit.C+\($iAnalysis\)
     fi
 fi
@@ -73,8 +89,8 @@ if [ "${arr[5]}" = "5y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q InvMassFit_MC.C\($iAnalysis,1\)
-        root -q InvMassFit.C\($iAnalysis,1\)
+        root -q $(LoadLib InvMassFit_MC.C) InvMassFit_MC.C\($iAnalysis,1\)
+        root -q $(LoadLib InvMassFit.C) InvMassFit.C\($iAnalysis,1\)
     else 
         root -q InvMassFit_MC.C+\($iAnalysis,1\)
         root -q InvMassFit.C+\($iAnalysis,1\)
@@ -86,10 +102,10 @@ if [ "${arr[6]}" = "6y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q AxE_Dissociative.cxx\($iAnalysis\)
-        root -q AxE_PtBins.cxx\($iAnalysis\)
-        root -q AxE_PtDep.cxx\($iAnalysis\)
-        root -q VetoEfficiency.C\($iAnalysis\)
+        root -q $(LoadLib AxE_Dissociative.cxx) AxE_Dissociative.cxx\($iAnalysis\)
+        root -q $(LoadLib AxE_PtBins.cxx) AxE_PtBins.cxx\($iAnalysis\)
+        root -q $(LoadLib AxE_PtDep.cxx) AxE_PtDep.cxx\($iAnalysis\)
+        root -q $(LoadLib VetoEfficiency.C) VetoEfficiency.C\($iAnalysis\)
     else 
         root -q AxE_PtBins.cxx+\($iAnalysis\)
         root -q AxE_Dissociative.cxx+\($iAnalysis\)
@@ -108,11 +124,11 @@ if [ "${arr[7]}" = "7y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q PtFit_SubtractBkg.C\($iAnalysis\)
-        root -q PtFit_PrepareMCTemplates.C\($iAnalysis\)
-        root -q PtFit_FeedDownNormalization.C\($iAnalysis\)
-        root -q PtFit_NoBkg.C\($iAnalysis\)
-        root -q STARlight_OptimalRA.C\($iAnalysis\)
+        root -q $(LoadLib PtFit_SubtractBkg.C) PtFit_SubtractBkg.C\($iAnalysis\)
+        root -q $(LoadLib PtFit_PrepareMCTemplates.C) PtFit_PrepareMCTemplates.C\($iAnalysis\)
+        root -q $(LoadLib PtFit_FeedDownNormalization.C) PtFit_FeedDownNormalization.C\($iAnalysis\)
+        root -q $(LoadLib PtFit_NoBkg.C) PtFit_NoBkg.C\($iAnalysis\)
+        root -q $(LoadLib STARlight_OptimalRA.C) STARlight_OptimalRA.C\($iAnalysis\)
     else 
         root -q PtFit_SubtractBkg.C+\($iAnalysis\)
         root -q PtFit_PrepareMCTemplates.C+\($iAnalysis\)
@@ -130,9 +146,9 @@ if [ "${arr[8]}" = "8y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q InvMassFit_SystUncertainties.C\($iAnalysis\)
-        root -q VertexZ_SystUncertainties.C\($iAnalysis\)
-        root -q PtFit_SystUncertainties.C\($iAnalysis\)
+        root -q $(LoadLib InvMassFit_SystUncertainties.C) InvMassFit_SystUncertainties.C\($iAnalysis\)
+        root -q $(LoadLib VertexZ_SystUncertainties.C) VertexZ_SystUncertainties.C\($iAnalysis\)
+        root -q $(LoadLib PtFit_SystUncertainties.C) PtFit_SystUncertainties.C\($iAnalysis\)
     else 
         root -q InvMassFit_SystUncertainties.C+\($iAnalysis\)
         root -q VertexZ_SystUncertainties.C+\($iAnalysis\)
@@ -152,13 +168,13 @@ if [ "${arr[9]}" = "9y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q STARlight_tVsPt2.cxx\($iAnalysis\)
-        root -q CrossSec_Calculate.C\($iAnalysis\)
-        root -q CrossSec_PrepareHistosAndGraphs.C\($iAnalysis\)
-        root -q CrossSec_Plot.C\($iAnalysis\)
-        root -q CrossSec_PlotWithRatios.C\($iAnalysis\)
-        root -q CrossSec_Fiducial.C\($iAnalysis\)
-        root -q CrossSec_ExpFits.cxx\($iAnalysis\)
+        root -q $(LoadLib STARlight_tVsPt2.cxx) STARlight_tVsPt2.cxx\($iAnalysis\)
+        root -q $(LoadLib CrossSec_Calculate.C) CrossSec_Calculate.C\($iAnalysis\)
+        root -q $(LoadLib CrossSec_PrepareHistosAndGraphs.C) CrossSec_PrepareHistosAndGraphs.C\($iAnalysis\)
+        root -q $(LoadLib CrossSec_Plot.C) CrossSec_Plot.C\($iAnalysis\)
+        root -q $(LoadLib CrossSec_PlotWithRatios.C) CrossSec_PlotWithRatios.C\($iAnalysis\)
+        root -q $(LoadLib CrossSec_Fiducial.C) CrossSec_Fiducial.C\($iAnalysis\)
+        root -q $(LoadLib CrossSec_ExpFits.cxx) CrossSec_ExpFits.cxx\($iAnalysis\)
     else 
         root -q STARlight_tVsPt2.cxx+\($iAnalysis\)
         root -q CrossSec_Calculate.C+\($iAnalysis\)
@@ -180,10 +196,10 @@ if [ "${arr[10]}" = "10y" ]
 then
     if [[ "$compile" -eq 0 ]]
     then 
-        root -q ResolutionPt.C\($iAnalysis\)
-        root -q MigrationPtRecGen.C\($iAnalysis\)
-        root -q ElectronsMuonsPID.C\($iAnalysis\)
-        root -q RaphaelleComments.C\($iAnalysis\)
+        root -q $(LoadLib ResolutionPt.C) ResolutionPt.C\($iAnalysis\)
+        root -q $(LoadLib MigrationPtRecGen.C) MigrationPtRecGen.C\($iAnalysis\)
+        root -q $(LoadLib ElectronsMuonsPID.C) ElectronsMuonsPID.C\($iAnalysis\)
+        root -q $(LoadLib RaphaelleComments.C) RaphaelleComments.C\($iAnalysis\)
     else 
         root -q ResolutionPt.C+\($iAnalysis\)
         root -q MigrationPtRecGen.C+\($iAnalysis\)
@@ -0,0 +1,240 @@
+// RunCounters.h
+// David Grund, Oct 19, 2026
+// Per-run counters of the analysed runs (LHC18q followed by LHC18r, as in runList_18q/r)
+// All counters are indexed by the position of the run in RunCounters_runs:
+//  - RunCounters_trigger:  CCUP31-triggered events (hCounterTrigger from the analysis task)
+//  - RunCounters_selected: events passing EventPassed(0, 2) (from the skim, see Skim_Utilities.h)
+//  - RunCounters_l2a, _classLumi, _classDs: CCUP31 class from the trending tree
+//  - RunCounters_lumiSeen: class_lumi scaled by (triggered events / l2a)
+// The run -> index map is built once, the luminosity is read from a small index of the trending tree
+// (see RunCounters_CreateLumiIndex, created by CreateLumiIndex.C).
+
+#ifndef RunCounters_h
+#define RunCounters_h
+
+// cpp headers
+#include <fstream>
+#include <map>
+#include <vector>
+// root headers
+#include "TFile.h"
+#include "TTree.h"
+#include "TList.h"
+#include "TH1.h"
+#include "TObjArray.h"
+#include "TString.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+#include "Skim_Utilities.h"
+
+const Int_t RunCounters_runPF = 295881; // from this run on, CCUP31 is CCUP31-B-SPD2-CENTNOTRD (past-future protection)
+TString RunCounters_className[2] = {"CCUP31-B-NOPF-CENTNOTRD", "CCUP31-B-SPD2-CENTNOTRD"};
+
+std::vector<Int_t> RunCounters_runs;
+std::map<Int_t,Int_t> RunCounters_index;
+std::vector<Double_t> RunCounters_trigger;
+std::vector<Double_t> RunCounters_selected;
+std::vector<Double_t> RunCounters_l2a;
+std::vector<Double_t> RunCounters_classLumi;
+std::vector<Double_t> RunCounters_classDs;
+std::vector<Double_t> RunCounters_lumiSeen;
+
+// (InitAnalysis must be called first)
+void RunCounters_Init()
+{
+    RunCounters_runs.clear();
+    RunCounters_index.clear();
+    for(Int_t i = 0; i < nRuns_18q; i++) RunCounters_runs.push_back(runList_18q[i]);
+    for(Int_t i = 0; i < nRuns_18r; i++) RunCounters_runs.push_back(runList_18r[i]);
+    Int_t nRuns = RunCounters_runs.size();
+    for(Int_t i = 0; i < nRuns; i++) RunCounters_index[RunCounters_runs[i]] = i;
+
+    RunCounters_trigger.assign(nRuns, 0.);
+    RunCounters_selected.assign(nRuns, 0.);
+    RunCounters_l2a.assign(nRuns, 0.);
+    RunCounters_classLumi.assign(nRuns, 0.);
+    RunCounters_classDs.assign(nRuns, 0.);
+    RunCounters_lumiSeen.assign(nRuns, 0.);
+
+    return;
+}
+
+// index of the run, -1 if the run is not analysed
+Int_t RunCounters_Index(Int_t run)
+{
+    std::map<Int_t,Int_t>::iterator it = RunCounters_index.find(run);
+    if(it == RunCounters_index.end()) return -1;
+    return it->second;
+}
+
+// 0 = LHC18q, 1 = LHC18r
+Int_t RunCounters_Period(Int_t i)
+{
+    return i < nRuns_18q ? 0 : 1;
+}
+
+Bool_t RunCounters_FillTriggers()
+{
+    TFile *f_in = TFile::Open((str_in_DT_fldr + "AnalysisResults.root").Data(), "read");
+    if(!f_in) return kFALSE;
+    TList *l_in = dynamic_cast<TList*> (f_in->Get("AnalysisOutput/fOutputList"));
+    if(!l_in) return kFALSE;
+    TH1F *hCounterTrigger = (TH1F*)l_in->FindObject("hCounterTrigger");
+    if(!hCounterTrigger) return kFALSE;
+    Printf("Histogram hCounterTrigger loaded.");
+
+    // the bins of the histogram correspond to run numbers
+    for(UInt_t i = 0; i < RunCounters_runs.size(); i++)
+    {
+        Int_t iBin = hCounterTrigger->FindFixBin(RunCounters_runs[i]);
+        if(hCounterTrigger->GetBinCenter(iBin) == RunCounters_runs[i]) RunCounters_trigger[i] = hCounterTrigger->GetBinContent(iBin);
+        else Printf("Run %i not found in hCounterTrigger.", RunCounters_runs[i]);
+    }
+    f_in->Close();
+
+    return kTRUE;
+}
+
+void RunCounters_FillSelected()
+{
+    TTree *tSkim = Skim_Open();
+    if(!tSkim) return;
+    // only the run number and the selection are needed
+    tSkim->SetBranchStatus("*", 0);
+    tSkim->SetBranchStatus("fRunNumber", 1);
+    tSkim->SetBranchStatus("fVertexZ", 1);
+    tSkim->SetBranchStatus("fSelMask", 1);
+    for(Long64_t iEntry = 0; iEntry < tSkim->GetEntries(); iEntry++)
+    {
+        tSkim->GetEntry(iEntry);
+        if(!Skim_EventPassed(0, 2)) continue;
+        Int_t i = RunCounters_Index(fRunNumber);
+        if(i >= 0) RunCounters_selected[i]++;
+    }
+
+    return;
+}
+
+// Index of the trending tree: one line per run with only the values of the CCUP31 classes
+//  run, then l2a, class_lumi and class_ds for each class in RunCounters_className (0 if the class is missing)
+// It is created once by CreateLumiIndex.C (requires the AliRoot libraries to read the trigger classes)
+// and recreated only if the trending file changes; reading it needs neither AliRoot nor the trending file.
+TString RunCounters_LumiIndexName(TString str_trending)
+{
+    TString str_index = str_trending;
+    str_index.ReplaceAll(".root", "_CCUP31_index.txt");
+    return str_index;
+}
+
+TString RunCounters_LumiIndexKey(TString str_trending)
+{
+    return StageCache_Key("RunCounters_LumiIndex", 1, {str_trending, "RunCounters.h", "CreateLumiIndex.C"}, RunCounters_className[0] + ";" + RunCounters_className[1]);
+}
+
+Bool_t RunCounters_CreateLumiIndex(TString str_trending, TString str_index)
+{
+    TFile *fTrendFile = TFile::Open(str_trending.Data(), "read");
+    if(!fTrendFile) return kFALSE;
+    TTree *fTree = dynamic_cast<TTree*> (fTrendFile->Get("trending"));
+    if(!fTree) return kFALSE;
+    Printf("Input tree %s loaded.", fTree->GetName());
+
+    const Int_t nClassesMax = 130;
+    TObjArray *classes = new TObjArray();
+    Double_t  class_lumi[nClassesMax] = {0};
+    Double_t  class_ds[nClassesMax] = {0};
+    ULong64_t class_l2a[nClassesMax] = {0};
+    Int_t run;
+    fTree->SetBranchStatus("*", 0);
+    fTree->SetBranchStatus("run", 1);
+    fTree->SetBranchStatus("classes", 1);
+    fTree->SetBranchStatus("class_lumi", 1);
+    fTree->SetBranchStatus("class_ds", 1);
+    fTree->SetBranchStatus("class_l2a", 1);
+    fTree->SetBranchAddress("run", &run);
+    fTree->SetBranchAddress("classes", &classes);
+    fTree->SetBranchAddress("class_lumi", &class_lumi);
+    fTree->SetBranchAddress("class_ds", &class_ds);
+    fTree->SetBranchAddress("class_l2a", &class_l2a);
+
+    ofstream outfile(str_index.Data());
+    // index of each class, kept as long as the list of classes stays the same
+    Int_t iClassCached[2] = {-1, -1};
+    Int_t nResolved = 0;
+    for(Long64_t iEntry = 0; iEntry < fTree->GetEntries(); iEntry++)
+    {
+        fTree->GetEntry(iEntry);
+        outfile << run;
+        for(Int_t iName = 0; iName < 2; iName++)
+        {
+            Int_t iClass = iClassCached[iName];
+            if(iClass < 0 || iClass >= classes->GetEntriesFast() || RunCounters_className[iName] != classes->At(iClass)->GetName())
+            {
+                TObject *cl = classes->FindObject(RunCounters_className[iName].Data());
+                iClass = cl ? classes->IndexOf(cl) : -1;
+                iClassCached[iName] = iClass;
+                nResolved++;
+            }
+            if(iClass < 0) outfile << "\t0\t0\t0";
+            else outfile << Form("\t%llu\t%.10g\t%.10g", class_l2a[iClass], class_lumi[iClass], class_ds[iClass]);
+        }
+        outfile << "\n";
+    }
+    outfile.close();
+    Printf("Index of the trending tree created: %s (%lli runs, class indices resolved %i times).", str_index.Data(), fTree->GetEntries(), nResolved);
+    fTrendFile->Close();
+
+    return kTRUE;
+}
+
+// iClassChoice: -1 = CCUP31 class valid for the run (NOPF before RunCounters_runPF, SPD2 after),
+//                0/1 = always RunCounters_className[iClassChoice]
+Bool_t RunCounters_FillLumi(TString str_trending = "Trees/Lumi/trending_merged_PbPb_2018.root", Int_t iClassChoice = -1)
+{
+    TString str_index = RunCounters_LumiIndexName(str_trending);
+    if(!StageCache_IsUpToDate(str_index, RunCounters_LumiIndexKey(str_trending)))
+    {
+        Printf("Index %s missing or out of date, run CreateLumiIndex.C first (inside ali shell).", str_index.Data());
+        return kFALSE;
+    }
+
+    ifstream ifs(str_index.Data());
+    if(ifs.fail()) return kFALSE;
+    Int_t run;
+    Double_t l2a[2], lumi[2], ds[2];
+    while(ifs >> run >> l2a[0] >> lumi[0] >> ds[0] >> l2a[1] >> lumi[1] >> ds[1])
+    {
+        Int_t i = RunCounters_Index(run);
+        if(i < 0) continue;
+        Int_t iName = iClassChoice;
+        if(iName < 0) iName = run < RunCounters_runPF ? 0 : 1;
+        RunCounters_l2a[i] = l2a[iName];
+        RunCounters_classLumi[i] = lumi[iName];
+        RunCounters_classDs[i] = ds[iName];
+        if(l2a[iName] > 0) RunCounters_lumiSeen[i] = RunCounters_trigger[i] / l2a[iName] * lumi[iName];
+    }
+    ifs.close();
+
+    return kTRUE;
+}
+
+// table with all counters (one line per run)
+void RunCounters_Print(TString name)
+{
+    ofstream outfile(name.Data());
+    outfile << "run\tperiod\ttrigger\tselected\tl2a\tclass_ds\tclass_lumi\tlumi_seen\n";
+    for(UInt_t i = 0; i < RunCounters_runs.size(); i++)
+    {
+        outfile << RunCounters_runs[i] << "\t" << (RunCounters_Period(i) == 0 ? "18q" : "18r") << "\t"
+                << RunCounters_trigger[i] << "\t" << RunCounters_selected[i] << "\t"
+                << Form("%.0f\t%.4f\t%.6f\t%.6f\n", RunCounters_l2a[i], RunCounters_classDs[i], RunCounters_classLumi[i], RunCounters_lumiSeen[i]);
+    }
+    outfile.close();
+    Printf("*** Results printed to %s.***", name.Data());
+
+    return;
+}
+
+#endif
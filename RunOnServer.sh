@@ -0,0 +1,33 @@
+#!/bin/bash
+# RunOnServer.sh
+# David Grund, Oct 19, 2026
+# Sends one request to AnalysisServer.C and waits until it is finished
+# shell script must be first allowed: chmod +x RunOnServer.sh
+# to run it do (the server must be running in the same folder):
+# ./RunOnServer.sh "PtFit_NoBkg.C+(3)"
+# ./RunOnServer.sh quit
+
+fifo="AnalysisServer.fifo"
+
+if [ ! -p "$fifo" ]
+then
+    echo "AnalysisServer is not running (fifo $fifo missing). Start it by: root -l -b -q AnalysisServer.C+ &"
+    exit 1
+fi
+
+if [ "$1" = "quit" ]
+then
+    echo "quit" > "$fifo"
+    exit 0
+fi
+
+# private fifo on which the server sends the exit code of the macro
+reply=$(mktemp -u /tmp/AnalysisServer_reply.XXXXXX)
+mkfifo "$reply"
+trap 'rm -f "$reply" "$reply.log"' EXIT
+
+echo "$reply $1" > "$fifo"
+read rc < "$reply"
+# print the output of the macro
+cat "$reply.log"
+exit $rc
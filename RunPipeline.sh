@@ -0,0 +1,342 @@
+#!/bin/bash
+# RunPipeline.sh
+# David Grund, Oct 19, 2026
+# Runs the macros of RunAnalysis.sh as a dependency graph:
+#  - each stage declares the files/folders it reads and writes
+#    (paths are relative to Results/<subfolder>/ and Trees/<subfolder>/, see AnalysisConfig.h)
+#  - a stage depends on all stages whose outputs overlap with its inputs
+#  - stages whose dependencies are finished run in parallel (at most nJobs at once)
+#  - at the end, the timing of each stage and the critical path are printed
+# shell script must be first allowed: chmod +x RunPipeline.sh
+# to run it do (inside ali shell):
+# ./RunPipeline.sh [iAnalysis] [compile] [nJobs] [plotMode]
+# if AnalysisServer.C is running, the stages are sent to it (see RunOnServer.sh)
+# instead of starting a new root process for each of them
+
+# define the type of the analysis (see AnalysisConfig.h)
+declare -i iAnalysis=${1:-3}
+# define if compile each macro
+declare -i compile=${2:-0}
+# define the maximum number of stages running at once
+declare -i nJobs=${3:-$(nproc)}
+# define how the plots are printed (see PlotStore.h):
+# store = the stages only store them, RenderPlots.C prints them after the last stage in nJobs processes
+# render = each stage prints its plots itself, skip = no plots
+# (AnalysisServer.C has to be started with the same PLOTSTORE_MODE)
+plotMode=${4:-store}
+export PLOTSTORE_MODE=$plotMode
+# define which steps to run (same numbering as in RunAnalysis.sh)
+# stages of steps that are not selected are considered finished (their outputs are taken from previous runs)
+# (the stages of step 0 run whenever a selected stage needs their caches)
+declare -a arr=("0" "1" "2" "3" "4" "5" "6" "7" "8" "9y" "10")
+#declare -a arr=("0" "1y" "2y" "3y" "4y" "5y" "6y" "7y" "8y" "9y" "10y")
+
+# #############################################################################################
+# Definition of the stages
+
+declare -a st_step st_name st_macro st_args st_in st_out
+
+# usage: AddStage step name macro args "inputs" "outputs"
+AddStage()
+{
+    st_step+=("$1")
+    st_name+=("$2")
+    st_macro+=("$3")
+    st_args+=("$4")
+    st_in+=("$5")
+    st_out+=("$6")
+}
+
+# 0) caches shared by several stages (skim and columnar cache of the data, MC columns of the migration matrix)
+# (created by one stage, so that the stages using them do not race to create them;
+#  "DataCache" stands for the columnar cache, which is stored next to the input data, see DataCache.h)
+AddStage 0 CreateCaches             CreateCaches.C                "$iAnalysis"   ""  "Trees/Skim DataCache Trees/MigrationMatrix"
+# 1) count events (data & MC) and do run list check
+AddStage 1 CountEvents              CountEvents.C                 "$iAnalysis"   ""  "Results/CountEvents"
+AddStage 1 CountEvents_MC           CountEvents_MC.C              "$iAnalysis"   ""  "Results/CountEvents_MC"
+AddStage 1 RunListCheck             RunListCheck.C                "$iAnalysis"   "Results/CountEvents"  "Results/RunListCheck"
+# 2) integrated luminosity
+AddStage 2 GetTriggerCounters       GetTriggerCounters.C          "$iAnalysis"   "Trees/Skim"  "Results/GetTriggerCounters"
+# ("LumiIndex" stands for the index of the trending file, which is shared by all analyses, see RunCounters.h)
+AddStage 2 CreateLumiIndex          CreateLumiIndex.C             ""             ""  "LumiIndex"
+AddStage 2 IntegratedLuminosity     IntegratedLuminosity.C        "$iAnalysis"   "LumiIndex"  "Results/Lumi"
+# 3) invariant mass fits of coh, inc, all and allbins
+AddStage 3 InvMassFit_MC_0          InvMassFit_MC.C               "$iAnalysis,0" "" \
+    "Results/InvMassFit_MC/inc Results/InvMassFit_MC/coh Results/InvMassFit_MC/all Results/InvMassFit_MC/allbins"
+AddStage 3 InvMassFit_0             InvMassFit.C                  "$iAnalysis,0" \
+    "Trees/Skim Results/InvMassFit_MC/inc Results/InvMassFit_MC/coh Results/InvMassFit_MC/all Results/InvMassFit_MC/allbins" \
+    "Trees/InvMassFit Results/InvMassFit/inc Results/InvMassFit/coh Results/InvMassFit/all Results/InvMassFit/allbins"
+# 4) pT binning via the invariant mass fitting
+AddStage 4 BinsThroughMassFit       BinsThroughMassFit.C          "$iAnalysis" \
+    "Trees/InvMassFit Results/InvMassFit/allbins Results/InvMassFit_MC/inc" \
+    "Results/BinsThroughMassFit"
+# 5) invariant mass fits in pT bins
+AddStage 5 InvMassFit_MC_1          InvMassFit_MC.C               "$iAnalysis,1" \
+    "Results/BinsThroughMassFit" \
+    "Results/InvMassFit_MC/bins"
+AddStage 5 InvMassFit_1             InvMassFit.C                  "$iAnalysis,1" \
+    "Results/BinsThroughMassFit Results/InvMassFit_MC/bins Trees/InvMassFit" \
+    "Results/InvMassFit/bins"
+# 6) AxE in pT bins and veto efficiency
+AddStage 6 AxE_Dissociative         AxE_Dissociative.cxx          "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/PtFit_SubtractBkg/bins_defined.txt" \
+    "Results/AxE_Dissociative"
+AddStage 6 AxE_PtBins               AxE_PtBins.cxx                "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/AxE_Dissociative" \
+    "Results/AxE_PtBins"
+AddStage 6 AxE_PtDep                AxE_PtDep.cxx                 "$iAnalysis"   ""  "Results/AxE_PtDep"
+AddStage 6 VetoEfficiency           VetoEfficiency.C              "$iAnalysis" \
+    "Results/BinsThroughMassFit" \
+    "Results/VetoEfficiency Trees/VetoEfficiency"
+# 7) fits of the transverse momentum distribution
+AddStage 7 PtFit_SubtractBkg        PtFit_SubtractBkg.C           "$iAnalysis" \
+    "Results/InvMassFit_MC/inc Results/InvMassFit_MC/coh" \
+    "Results/PtFit_SubtractBkg Trees/PtFit/PtFit.root Trees/PtFit/SignalWithBkgSubtracted.root"
+AddStage 7 PtFit_PrepareMCTemplates PtFit_PrepareMCTemplates.C    "$iAnalysis" \
+    "Results/PtFit_SubtractBkg/bins_defined.txt" \
+    "Trees/PtFit/MCTemplates.root Results/PtFit_NoBkg/modRA_CohJ_ratios"
+AddStage 7 PtFit_FeedDownNormalization PtFit_FeedDownNormalization.C "$iAnalysis" "" \
+    "Results/PtFit_FeedDownNormalization"
+AddStage 7 PtFit_NoBkg              PtFit_NoBkg.C                 "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/PtFit_SubtractBkg/bins_defined.txt Trees/PtFit/MCTemplates.root Trees/PtFit/SignalWithBkgSubtracted.root Results/PtFit_FeedDownNormalization" \
+    "Results/PtFit_NoBkg/RecSh4_fD0_fC.txt Results/PtFit_NoBkg/RecSh4_fD0_fD.txt Results/PtFit_NoBkg/OptimalRA/Fits Results/AxE_Dissociative/fromPtFit.txt"
+AddStage 7 STARlight_OptimalRA      STARlight_OptimalRA.C         "$iAnalysis" \
+    "Results/PtFit_NoBkg/OptimalRA/Fits" \
+    "Results/PtFit_NoBkg/OptimalRA/fit_RA.pdf"
+# 8) systematic uncertainties
+AddStage 8 InvMassFit_SystUncertainties InvMassFit_SystUncertainties.C "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/InvMassFit_MC Results/InvMassFit Trees/InvMassFit" \
+    "Results/InvMassFit_SystUncertainties"
+AddStage 8 VertexZ_SystUncertainties VertexZ_SystUncertainties.C  "$iAnalysis" \
+    "Trees/Skim Results/BinsThroughMassFit Results/InvMassFit_MC Results/AxE_Dissociative" \
+    "Results/VertexZ_SystUncertainties Trees/VertexZ_SystUncertainties"
+AddStage 8 PtFit_SystUncertainties  PtFit_SystUncertainties.C     "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/PtFit_SubtractBkg/bins_defined.txt Trees/PtFit/MCTemplates.root Trees/PtFit/SignalWithBkgSubtracted.root Results/PtFit_FeedDownNormalization Results/PtFit_NoBkg/RecSh4_fD0_fD.txt" \
+    "Results/PtFit_SystUncertainties"
+# 9) photonuclear cross section
+AddStage 9 STARlight_tVsPt2         STARlight_tVsPt2.cxx          "$iAnalysis" \
+    "Results/BinsThroughMassFit" \
+    "Results/STARlight_tVsPt2"
+AddStage 9 CrossSec_Calculate       CrossSec_Calculate.C          "$iAnalysis" \
+    "Results/BinsThroughMassFit Results/Lumi Results/InvMassFit/allbins Results/InvMassFit/bins Results/AxE_PtBins Results/PtFit_SystUncertainties Results/PtFit_NoBkg/RecSh4_fD0_fC.txt Results/InvMassFit_SystUncertainties Results/VertexZ_SystUncertainties Results/STARlight_tVsPt2" \
+    "Results/CrossSec/CrossSec_UPC.txt Results/CrossSec/Systematics.txt Results/CrossSec/CrossSec_photo.txt Results/CrossSec/CrossSec_fiducial_dir.txt Results/CrossSec/yield_to_sig_upc.txt"
+# (CrossSec_PrepareHistosAndGraphs also creates the binary cache of the model tables, see ModelStore.h)
+AddStage 9 CrossSec_PrepareHistosAndGraphs CrossSec_PrepareHistosAndGraphs.C "$iAnalysis" \
+    "Results/CrossSec/CrossSec_photo.txt" \
+    "Results/CrossSec/PrepareHistosAndGraphs Results/CrossSec/HistogramsFromGraphs Trees/ModelStore"
+AddStage 9 CrossSec_Plot            CrossSec_Plot.C               "$iAnalysis" \
+    "Results/CrossSec/PrepareHistosAndGraphs" \
+    "Results/CrossSec/Plot"
+AddStage 9 CrossSec_PlotWithRatios  CrossSec_PlotWithRatios.C     "$iAnalysis" \
+    "Results/CrossSec/PrepareHistosAndGraphs" \
+    "Results/CrossSec/PlotWithRatios"
+AddStage 9 CrossSec_Fiducial        CrossSec_Fiducial.C           "$iAnalysis" \
+    "Results/CrossSec/CrossSec_fiducial_dir.txt Trees/ModelStore" \
+    "Results/CrossSec/Fiducial Results/CrossSec/CrossSec_fiducial_int.txt Results/CrossSec/Integrals"
+AddStage 9 CrossSec_ExpFits         CrossSec_ExpFits.cxx          "$iAnalysis" \
+    "Results/CrossSec/PrepareHistosAndGraphs" \
+    "Results/CrossSec/ExpFits"
+AddStage 9 CrossSec_KSTest          CrossSec_KSTest.cxx           "$iAnalysis" \
+    "Results/CrossSec/PrepareHistosAndGraphs Trees/ModelStore" \
+    "Results/CrossSec/KSTest Trees/CrossSec_KSTest"
+# 10) extra macros
+AddStage 10 ResolutionPt            ResolutionPt.C                "$iAnalysis" \
+    "Results/BinsThroughMassFit Trees/MigrationMatrix" \
+    "Results/ResolutionPt Trees/ResolutionPt"
+AddStage 10 MigrationPtRecGen       MigrationPtRecGen.C           "$iAnalysis" \
+    "Results/BinsThroughMassFit Trees/MigrationMatrix" \
+    "Results/MigrationPtRecGen"
+AddStage 10 CrossSec_Bootstrap      CrossSec_Bootstrap.C          "$iAnalysis" \
+    "Trees/InvMassFit Results/InvMassFit_MC Results/InvMassFit/allbins Results/InvMassFit/bins Results/CrossSec/yield_to_sig_upc.txt" \
+    "Results/CrossSec/Bootstrap"
+AddStage 10 ElectronsMuonsPID       ElectronsMuonsPID.C           "$iAnalysis"   "DataCache"  "Results/ElectronsMuonsPID"
+AddStage 10 RaphaelleComments       RaphaelleComments.C           "$iAnalysis" \
+    "Results/BinsThroughMassFit DataCache" \
+    "Results/RaphaelleComments"
+
+declare -i nStages=${#st_name[@]}
+
+# #############################################################################################
+# Build the dependency graph
+
+# returns 0 if one path is equal to the other one or lies inside it
+PathsOverlap()
+{
+    [[ "$1" == "$2" || "$1" == "$2"/* || "$2" == "$1"/* ]]
+}
+
+declare -a st_deps
+for ((i = 0; i < nStages; i++)); do
+    st_deps[i]=""
+    for ((j = 0; j < nStages; j++)); do
+        [[ $i -eq $j ]] && continue
+        for p_in in ${st_in[i]}; do
+            for p_out in ${st_out[j]}; do
+                if PathsOverlap "$p_in" "$p_out"; then
+                    [[ " ${st_deps[i]} " != *" $j "* ]] && st_deps[i]+=" $j"
+                fi
+            done
+        done
+    done
+done
+
+# #############################################################################################
+# Run the stages
+
+# status: pending, running, done, failed, blocked, skipped
+declare -a st_status st_time
+for ((i = 0; i < nStages; i++)); do
+    st_time[i]=0
+    if [ "${arr[${st_step[i]}]}" = "${st_step[i]}y" ]
+    then st_status[i]="pending"
+    else st_status[i]="skipped"
+    fi
+done
+for ((i = 0; i < nStages; i++)); do
+    [ "${st_status[i]}" = "pending" ] || continue
+    for j in ${st_deps[i]}; do
+        [ "${st_step[j]}" = "0" ] && st_status[j]="pending"
+    done
+done
+
+logDir="Logs/Pipeline_iAnalysis$iAnalysis"
+mkdir -p "$logDir"
+tmpDir=$(mktemp -d)
+trap 'rm -rf "$tmpDir"' EXIT
+# plots stored after this file are rendered at the end (older plots in the store come from previous runs)
+touch "$tmpDir/start"
+
+# milliseconds to seconds
+ToSeconds()
+{
+    awk -v t="$1" 'BEGIN { printf "%.3f", t / 1000 }'
+}
+
+# interpreted macros are run with the library of the common code, if it was built (see BuildJpsiAnalysisLib.C):
+# prints the argument of root that loads the library needed by the macro, e.g. LoadJpsiAnalysisLib.C("PtFit")
+LoadLib()
+{
+    local family="Core"
+    if   grep -q '#include "InvMassFit_Utilities.h"' "$1"; then family="InvMassFit"
+    elif grep -q '#include "PtFit_Utilities.h"' "$1"; then family="PtFit"
+    elif grep -q '#include "CrossSec_Utilities.h"' "$1"; then family="CrossSec"
+    elif ! grep -q '#include "AnalysisManager.h"' "$1"; then return
+    fi
+    ls lib/libJpsiAnalysis_${family}_v*.so > /dev/null 2>&1 && echo "LoadJpsiAnalysisLib.C(\"$family\")"
+}
+
+RunStage()
+{
+    local i=$1
+    local macro=${st_macro[i]}
+    local lib=""
+    if [[ "$compile" -ne 0 ]]; then macro+="+"; else lib=$(LoadLib "$macro"); fi
+    local t_start=$(date +%s%3N)
+    if [ -p AnalysisServer.fifo ]
+    then ./RunOnServer.sh "$macro(${st_args[i]})" > "$logDir/${st_name[i]}.log" 2>&1
+    else root -l -b -q $lib "$macro(${st_args[i]})" > "$logDir/${st_name[i]}.log" 2>&1
+    fi
+    local rc=$?
+    local t_end=$(date +%s%3N)
+    echo "$rc $((t_end - t_start))" > "$tmpDir/$i.done"
+}
+
+declare -i nRunning=0
+declare -i nLeft=0
+for ((i = 0; i < nStages; i++)); do
+    [ "${st_status[i]}" = "pending" ] && nLeft+=1
+done
+declare -i t_pipeline_start=$(date +%s%3N)
+
+while [[ $nLeft -gt 0 || $nRunning -gt 0 ]]; do
+    # collect finished stages
+    for ((i = 0; i < nStages; i++)); do
+        if [[ "${st_status[i]}" = "running" && -f "$tmpDir/$i.done" ]]; then
+            read rc dt < "$tmpDir/$i.done"
+            st_time[i]=$dt
+            if [[ $rc -eq 0 ]]; then st_status[i]="done"; else st_status[i]="failed"; fi
+            nRunning=nRunning-1
+            printf "[%s] %-32s %s (%.1f s)\n" "$(date +%T)" "${st_name[i]}" "${st_status[i]}" "$(ToSeconds $dt)"
+        fi
+    done
+    # launch stages whose dependencies are finished
+    for ((i = 0; i < nStages; i++)); do
+        [ "${st_status[i]}" = "pending" ] || continue
+        ready=1
+        for j in ${st_deps[i]}; do
+            case "${st_status[j]}" in
+                done|skipped) ;;
+                failed|blocked) ready=-1; break ;;
+                *) ready=0 ;;
+            esac
+        done
+        if [[ $ready -eq -1 ]]; then
+            st_status[i]="blocked"
+            nLeft=nLeft-1
+            printf "[%s] %-32s blocked (a dependency failed)\n" "$(date +%T)" "${st_name[i]}"
+        elif [[ $ready -eq 1 && $nRunning -lt $nJobs ]]; then
+            st_status[i]="running"
+            nRunning+=1
+            nLeft=nLeft-1
+            printf "[%s] %-32s started\n" "$(date +%T)" "${st_name[i]}"
+            RunStage $i &
+        fi
+    done
+    [[ $nLeft -gt 0 || $nRunning -gt 0 ]] && sleep 1
+done
+wait
+
+# print the stored plots
+if [ "$plotMode" = "store" ]; then
+    declare -i t_render_start=$(date +%s%3N)
+    root -l -b -q "RenderPlots.C+($iAnalysis,$nJobs,\"\",\"$tmpDir/start\")" > "$logDir/RenderPlots.log" 2>&1
+    printf "[%s] %-32s done (%.1f s)\n" "$(date +%T)" "RenderPlots" "$(ToSeconds $(( $(date +%s%3N) - t_render_start )))"
+fi
+
+declare -i t_wall=$(( $(date +%s%3N) - t_pipeline_start ))
+
+# #############################################################################################
+# Timing report and critical path
+
+# longest chain of durations ending at each stage (stages are relaxed nStages times, enough for any DAG)
+declare -a cp_time cp_prev
+for ((i = 0; i < nStages; i++)); do cp_time[i]=${st_time[i]}; cp_prev[i]=-1; done
+for ((pass = 0; pass < nStages; pass++)); do
+    for ((i = 0; i < nStages; i++)); do
+        for j in ${st_deps[i]}; do
+            if [[ $((cp_time[j] + st_time[i])) -gt ${cp_time[i]} ]]; then
+                cp_time[i]=$((cp_time[j] + st_time[i]))
+                cp_prev[i]=$j
+            fi
+        done
+    done
+done
+declare -i iLast=0
+declare -i t_sum=0
+for ((i = 0; i < nStages; i++)); do
+    t_sum+=${st_time[i]}
+    [[ ${cp_time[i]} -gt ${cp_time[iLast]} ]] && iLast=$i
+done
+path="${st_name[iLast]}"
+i=${cp_prev[iLast]}
+while [[ $i -ge 0 ]]; do
+    path="${st_name[i]} -> $path"
+    i=${cp_prev[i]}
+done
+
+echo ""
+echo "*** Pipeline finished (iAnalysis = $iAnalysis, $nJobs parallel jobs). ***"
+printf "%-34s %5s %9s %10s\n" "stage" "step" "status" "time [s]"
+for ((i = 0; i < nStages; i++)); do
+    printf "%-34s %5s %9s %10.1f\n" "${st_name[i]}" "${st_step[i]}" "${st_status[i]}" "$(ToSeconds ${st_time[i]})"
+done
+printf "Wall time:           %10.1f s\n" "$(ToSeconds $t_wall)"
+printf "Sum of stage times:  %10.1f s\n" "$(ToSeconds $t_sum)"
+printf "Critical path:       %10.1f s\n" "$(ToSeconds ${cp_time[iLast]})"
+echo "  $path"
+echo "Logs of all stages stored in $logDir/"
+
+for ((i = 0; i < nStages; i++)); do
+    [[ "${st_status[i]}" = "failed" || "${st_status[i]}" = "blocked" ]] && exit 1
+done
+exit 0
@@ -1,6 +1,9 @@
 // SetPtBinning.h
 // David Grund, Mar 20, 2022
 
+#ifndef SetPtBinning_h
+#define SetPtBinning_h
+
 #include <fstream>
 
 Double_t PtBins_4bins[5] = { 0 };
@@ -38,4 +41,6 @@ void SetPtBinning()
     }
 
     return;
-}
\ No newline at end of file
+}
+
+#endif
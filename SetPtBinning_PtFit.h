@@ -1,6 +1,9 @@
 // SetPtBinning_PtFit.h
 // David Grund, Mar 20, 2022
 
+#ifndef SetPtBinning_PtFit_h
+#define SetPtBinning_PtFit_h
+
 #include <fstream>
 #include <sstream> 
 #include "RooBinning.h"
@@ -53,4 +56,6 @@ void SetPtBinning_PtFit()
     }
 
     return;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,191 @@
+// Skim_Utilities.h
+// David Grund, Oct 19, 2026
+// Compact skim of the data candidates (created once from AnalysisResults.root)
+// - all candidate variables stored once, as float32 columns (enough for fits and histograms)
+// - fSelMask: bitmask with the result of EventPassed(iMassCut, iPtCut) for all combinations
+//   of iMassCut = -1..2 and iPtCut = -1..3, bit = 5*(iMassCut+1) + (iPtCut+1)
+// - the selection is evaluated with the loosest cut on vertex Z (Skim_cutZ_max), the actual cut
+//   is applied when reading (Skim_EventPassed), so the skim serves all Z-cut variations
+// - LZ4 compression and large baskets (fast reading, small files)
+// The skim is recreated only if the input data or the selection changed (see StageCache.h).
+
+#ifndef Skim_Utilities_h
+#define Skim_Utilities_h
+
+// cpp headers
+#include <vector>
+// root headers
+#include "TSystem.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TString.h"
+#include "Compression.h"
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "StageCache.h"
+
+const Double_t Skim_cutZ_max = 15.; // loosest cut on vertex Z used in the analysis [cm]
+const Int_t Skim_bufsize = 256000; // basket size [bytes]
+
+Float_t skim_fPt, skim_fM, skim_fY, skim_fPhi, skim_fVertexZ, skim_fZNA_energy, skim_fZNC_energy;
+UInt_t skim_fSelMask;
+
+TString Skim_FileName()
+{
+    return "Trees/" + str_subfolder + "Skim/Skim.root";
+}
+
+UInt_t Skim_Bit(Int_t iMassCut, Int_t iPtCut)
+{
+    return 1u << (5*(iMassCut+1) + (iPtCut+1));
+}
+
+void Skim_ConnectTreeVariables(TTree *t)
+{
+    t->SetBranchAddress("fRunNumber", &fRunNumber);
+    t->SetBranchAddress("fPt", &skim_fPt);
+    t->SetBranchAddress("fM", &skim_fM);
+    t->SetBranchAddress("fY", &skim_fY);
+    t->SetBranchAddress("fPhi", &skim_fPhi);
+    t->SetBranchAddress("fVertexZ", &skim_fVertexZ);
+    t->SetBranchAddress("fZNA_energy", &skim_fZNA_energy);
+    t->SetBranchAddress("fZNC_energy", &skim_fZNC_energy);
+    t->SetBranchAddress("fSelMask", &skim_fSelMask);
+
+    Printf("Variables from %s connected.", t->GetName());
+
+    return;
+}
+
+// copy the values of the current skim entry to the global variables of AnalysisManager.h
+void Skim_CopyToGlobals()
+{
+    fPt = skim_fPt;
+    fM = skim_fM;
+    fY = skim_fY;
+    fPhi = skim_fPhi;
+    fVertexZ = skim_fVertexZ;
+    fZNA_energy = skim_fZNA_energy;
+    fZNC_energy = skim_fZNC_energy;
+
+    return;
+}
+
+// equivalent of EventPassed(iMassCut, iPtCut) for the current skim entry
+Bool_t Skim_EventPassed(Int_t iMassCut, Int_t iPtCut)
+{
+    if(!(skim_fSelMask & Skim_Bit(iMassCut, iPtCut))) return kFALSE;
+    if(isPass3 && skim_fVertexZ > cut_fVertexZ) return kFALSE;
+    return kTRUE;
+}
+
+// create a tree with float columns, tuned baskets (used also for the trees derived from the skim)
+TTree *Skim_NewTree(TString name, std::vector<TString> vars)
+{
+    TTree *t = new TTree(name.Data(), name.Data());
+    Float_t *address = NULL;
+    for(UInt_t i = 0; i < vars.size(); i++)
+    {
+        if(vars[i] == "fPt") address = &skim_fPt;
+        else if(vars[i] == "fM") address = &skim_fM;
+        else if(vars[i] == "fY") address = &skim_fY;
+        else if(vars[i] == "fPhi") address = &skim_fPhi;
+        else if(vars[i] == "fVertexZ") address = &skim_fVertexZ;
+        else if(vars[i] == "fZNA_energy") address = &skim_fZNA_energy;
+        else if(vars[i] == "fZNC_energy") address = &skim_fZNC_energy;
+        else { Printf("Variable %s not in the skim.", vars[i].Data()); continue; }
+        t->Branch(vars[i].Data(), address, (vars[i] + "/F").Data(), Skim_bufsize);
+    }
+    // flush the baskets every ~30 MB of (uncompressed) data
+    t->SetAutoFlush(-30000000);
+
+    return t;
+}
+
+TFile *Skim_NewFile(TString name)
+{
+    TFile *f = new TFile(name.Data(), "RECREATE");
+    f->SetCompressionSettings(ROOT::CompressionSettings(ROOT::kLZ4, 4));
+
+    return f;
+}
+
+void Skim_Create()
+{
+    TString name = Skim_FileName();
+    TString str_in = str_in_DT_fldr + "AnalysisResults.root";
+    // the skim does not depend on cut_fVertexZ (applied when reading)
+    Double_t fCutZ_orig = cut_fVertexZ;
+    cut_fVertexZ = Skim_cutZ_max;
+    TString key = StageCache_Key("Skim_Create", 1, {str_in, "Skim_Utilities.h", "AnalysisManager.h", "ListsOfGoodRuns.h"}, AnalysisConfig_ToString());
+    if(StageCache_IsUpToDate(name, key)){
+        Printf("Skim already created and up to date.");
+        cut_fVertexZ = fCutZ_orig;
+        return;
+    }
+
+    Printf("Skim will be created.");
+    gSystem->Exec("mkdir -p Trees/" + str_subfolder + "Skim/");
+
+    TFile *f_in = TFile::Open(str_in.Data(), "read");
+    if(f_in) Printf("Input data loaded.");
+    TTree *t_in = dynamic_cast<TTree*> (f_in->Get(str_in_DT_tree.Data()));
+    if(t_in) Printf("Input tree loaded.");
+    ConnectTreeVariables(t_in);
+
+    TFile *file = Skim_NewFile(name);
+    TTree *tSkim = Skim_NewTree("tSkim", {"fPt", "fM", "fY", "fPhi", "fVertexZ", "fZNA_energy", "fZNC_energy"});
+    tSkim->Branch("fRunNumber", &fRunNumber, "fRunNumber/I", Skim_bufsize);
+    tSkim->Branch("fSelMask", &skim_fSelMask, "fSelMask/i", Skim_bufsize);
+
+    Printf("%lli entries found in the tree.", t_in->GetEntries());
+    Int_t nEntriesAnalysed = 0;
+
+    for(Int_t iEntry = 0; iEntry < t_in->GetEntries(); iEntry++)
+    {
+        t_in->GetEntry(iEntry);
+        skim_fSelMask = 0;
+        for(Int_t iMassCut = -1; iMassCut <= 2; iMassCut++)
+            for(Int_t iPtCut = -1; iPtCut <= 3; iPtCut++)
+                if(EventPassed(iMassCut, iPtCut)) skim_fSelMask |= Skim_Bit(iMassCut, iPtCut);
+        if(skim_fSelMask != 0)
+        {
+            skim_fPt = fPt;
+            skim_fM = fM;
+            skim_fY = fY;
+            skim_fPhi = fPhi;
+            skim_fVertexZ = isPass3 ? fVertexZ : 0.;
+            skim_fZNA_energy = fZNA_energy;
+            skim_fZNC_energy = fZNC_energy;
+            tSkim->Fill();
+        }
+
+        if((iEntry+1) % 100000 == 0){
+            nEntriesAnalysed += 100000;
+            Printf("%i entries analysed.", nEntriesAnalysed);
+        }
+    }
+    cut_fVertexZ = fCutZ_orig;
+
+    file->Write("",TObject::kWriteDelete);
+    Printf("%lli entries saved to the skim.", tSkim->GetEntries());
+    file->Close();
+    f_in->Close();
+    StageCache_Update(name, key, "Skim_Create");
+
+    return;
+}
+
+TTree *Skim_Open()
+{
+    Skim_Create();
+    TFile *f = TFile::Open(Skim_FileName().Data(), "read");
+    if(!f) return NULL;
+    TTree *t = dynamic_cast<TTree*> (f->Get("tSkim"));
+    if(t) Skim_ConnectTreeVariables(t);
+
+    return t;
+}
+
+#endif
@@ -0,0 +1,81 @@
+// StageCache.h
+// David Grund, Oct 19, 2026
+// Decide whether an intermediate output (tree, templates, ...) has to be recreated
+// The key of each stage is an MD5 hash of:
+//  - the name and version of the stage (increase the version when the format of the output changes)
+//  - the fingerprints of all input files, including the header or macro with the code of the stage
+//    (so that editing the code of the stage recreates its output)
+//  - the configuration string (cuts, binning, options set by iAnalysis)
+// The key is stored next to the output (<output>.key); the stage only re-runs if the keys differ
+
+#ifndef StageCache_h
+#define StageCache_h
+
+// cpp headers
+#include <fstream>
+#include <vector>
+// root headers
+#include "TSystem.h"
+#include "TString.h"
+#include "TMD5.h"
+
+// files smaller than this are hashed by their content, bigger ones by their size and modification time
+// (so that checking the key of a stage with multi-GB inputs costs nothing)
+const Long64_t StageCache_maxSizeToHash = 100000000; // bytes
+
+TString StageCache_FileFingerprint(TString path)
+{
+    FileStat_t stat;
+    // the file does not exist
+    if(gSystem->GetPathInfo(path.Data(), stat) != 0) return path + ":missing";
+    // small files: hash of the content
+    if(stat.fSize < StageCache_maxSizeToHash)
+    {
+        TMD5 *md5 = TMD5::FileChecksum(path.Data());
+        // the file cannot be read
+        if(!md5) return path + ":unreadable";
+        TString fingerprint = path + ":" + md5->AsString();
+        delete md5;
+        return fingerprint;
+    }
+    // large files: size and time of the last modification
+    return path + Form(":%lli:%li", stat.fSize, stat.fMtime);
+}
+
+TString StageCache_Key(TString stage, Int_t version, std::vector<TString> inputs, TString config)
+{
+    TString str = stage + Form(";v%i;", version) + config;
+    for(UInt_t i = 0; i < inputs.size(); i++) str += ";" + StageCache_FileFingerprint(inputs[i]);
+
+    TMD5 md5;
+    md5.Update((const UChar_t*)str.Data(), str.Length());
+    md5.Final();
+
+    return md5.AsString();
+}
+
+Bool_t StageCache_IsUpToDate(TString output, TString key)
+{
+    // output missing => stage has to run
+    if(gSystem->AccessPathName(output.Data())) return kFALSE;
+    // output created without a key (or by an older version of the code) => stage has to run
+    ifstream ifs((output + ".key").Data());
+    if(ifs.fail()) return kFALSE;
+    std::string stored;
+    ifs >> stored;
+    ifs.close();
+
+    return (key == stored.data());
+}
+
+void StageCache_Update(TString output, TString key, TString description = "")
+{
+    ofstream ofs((output + ".key").Data());
+    ofs << key << "\n" << description << "\n";
+    ofs.close();
+    Printf("Key of %s updated: %s", output.Data(), key.Data());
+
+    return;
+}
+
+#endif
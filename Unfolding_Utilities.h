@@ -0,0 +1,333 @@
+// Unfolding_Utilities.h
+// David Grund, Oct 19, 2026
+// Unfolding engine working directly on the response matrix of RooUnfoldResponse
+// Bayes (D'Agostini): all iterations are done in one pass, the unfolded spectrum and its covariance
+// are stored after every iteration (instead of a new RooUnfoldBayes for each number of iterations,
+// which repeats all the previous iterations). The covariance includes the dependence of the prior
+// on the measured spectrum from the previous iterations (Adye's correction, as in RooUnfoldBayes).
+// SVD and bin-by-bin: RooUnfoldSvd/RooUnfoldBinByBin on the same response.
+// Response matrix: |t| at the rec and gen level of the selected MC events (see MigrationMatrix.h),
+// the training and testing spectra of all folds of a train/test split are then filled in one pass
+// by nThreads threads, each with its own partial matrices (merged at the end). The response of
+// a fold is built from the sum of all the other folds.
+// The vectors follow the convention of RooUnfold: with UseOverflow, index 0 = underflow bin,
+// index nBins+1 = overflow bin, otherwise index i = bin i+1.
+
+#ifndef Unfolding_Utilities_h
+#define Unfolding_Utilities_h
+
+#if !(defined(__CINT__) || defined(__CLING__)) || defined(__ACLIC__)
+// cpp headers
+#include <vector>
+#include <thread>
+#include <algorithm>
+// root headers
+#include "TH1.h"
+#include "TH2.h"
+#include "TRandom3.h"
+#include "TMath.h"
+#include "TMatrixD.h"
+#include "TVectorD.h"
+#include "RooUnfoldResponse.h"
+#include "RooUnfoldSvd.h"
+#include "RooUnfoldBinByBin.h"
+#endif
+// my headers
+#include "AnalysisManager.h"
+#include "AnalysisConfig.h"
+#include "MigrationMatrix.h"
+
+// MC columns (events passing EventPassedMCRec(0,-1)): entry in the tree, |t| at the rec and gen level
+std::vector<Int_t> Unfolding_mcEntry;
+std::vector<Float_t> Unfolding_mcRec;
+std::vector<Float_t> Unfolding_mcGen;
+Int_t Unfolding_mcEntries = 0; // number of entries in the MC tree
+// fold of each row (set by Unfolding_SetSplit) and the counts of all folds (set by Unfolding_FillFolds):
+// for each fold: rec spectrum, gen spectrum, response (rec bin x gen bin), all with under/overflow bins
+std::vector<Int_t> Unfolding_mcFold;
+std::vector<Double_t> Unfolding_foldCounts;
+Int_t Unfolding_nFolds = 0;
+Int_t Unfolding_nBins = 0;
+std::vector<Float_t> Unfolding_edges;
+
+// |t| at the rec and gen level from the shared MC columns (see MigrationMatrix.h)
+Bool_t Unfolding_LoadMC()
+{
+    if(!MigrationMatrix_Load()) return kFALSE;
+    Int_t nRows = MigrationMatrix_GetEntries();
+    Unfolding_mcEntries = MigrationMatrix_nEntries;
+    Unfolding_mcEntry = MigrationMatrix_entry;
+    Unfolding_mcRec.resize(nRows);
+    Unfolding_mcGen.resize(nRows);
+    for(Int_t i = 0; i < nRows; i++)
+    {
+        Unfolding_mcRec[i] = MigrationMatrix_ptRec[i] * MigrationMatrix_ptRec[i];
+        Unfolding_mcGen[i] = MigrationMatrix_ptGen[i] * MigrationMatrix_ptGen[i];
+    }
+
+    return kTRUE;
+}
+
+// nFolds < 2: the first fTrain of the tree entries are used for training (fold 1), the rest for testing (fold 0)
+// nFolds >= 2: the rows are shuffled with the given seed and divided into nFolds folds of the same size
+// returns the number of folds
+Int_t Unfolding_SetSplit(Int_t nFolds, UInt_t seed, Float_t fTrain = 0.8)
+{
+    Int_t nRows = Unfolding_mcEntry.size();
+    Unfolding_mcFold.assign(nRows, 0);
+    if(nFolds < 2)
+    {
+        Int_t nTrain = (Int_t)(Unfolding_mcEntries * fTrain);
+        for(Int_t i = 0; i < nRows; i++) Unfolding_mcFold[i] = Unfolding_mcEntry[i] < nTrain ? 1 : 0;
+        return 2;
+    }
+    std::vector<Int_t> order(nRows);
+    for(Int_t i = 0; i < nRows; i++) order[i] = i;
+    TRandom3 rnd(seed);
+    for(Int_t i = nRows - 1; i > 0; i--) std::swap(order[i], order[rnd.Integer(i+1)]);
+    for(Int_t i = 0; i < nRows; i++) Unfolding_mcFold[order[i]] = i % nFolds;
+
+    return nFolds;
+}
+
+// bin of the value (0 = underflow, n+1 = overflow), as TAxis::FindFixBin
+Int_t Unfolding_FindBin(Float_t val, Int_t n, const Float_t* edges)
+{
+    if(val < edges[0]) return 0;
+    return std::upper_bound(edges, edges + n + 1, val) - edges;
+}
+
+Int_t Unfolding_FoldSize()
+{
+    Int_t nB = Unfolding_nBins + 2;
+    return 2*nB + nB*nB;
+}
+
+// fill the partial counts of all folds from the rows [first, last)
+void Unfolding_FillWorker(Int_t first, Int_t last, std::vector<Double_t>* counts)
+{
+    Int_t nB = Unfolding_nBins + 2;
+    Int_t size = Unfolding_FoldSize();
+    counts->assign(Unfolding_nFolds * size, 0.);
+    for(Int_t i = first; i < last; i++)
+    {
+        Double_t* c = &(*counts)[Unfolding_mcFold[i] * size];
+        Int_t iRec = Unfolding_FindBin(Unfolding_mcRec[i], Unfolding_nBins, Unfolding_edges.data());
+        Int_t iGen = Unfolding_FindBin(Unfolding_mcGen[i], Unfolding_nBins, Unfolding_edges.data());
+        c[iRec]++;
+        c[nB + iGen]++;
+        c[2*nB + iRec*nB + iGen]++;
+    }
+
+    return;
+}
+
+void Unfolding_FillFolds(Int_t nFolds, Int_t nBins, Float_t* edges, Int_t nThreads)
+{
+    Unfolding_nFolds = nFolds;
+    Unfolding_nBins = nBins;
+    Unfolding_edges.assign(edges, edges + nBins + 1);
+    Int_t nRows = Unfolding_mcRec.size();
+    if(nThreads < 1) nThreads = 1;
+    std::vector<std::vector<Double_t> > partial(nThreads);
+    std::vector<std::thread> threads;
+    for(Int_t iThr = 0; iThr < nThreads; iThr++)
+    {
+        Int_t first = (Long64_t)nRows * iThr / nThreads;
+        Int_t last = (Long64_t)nRows * (iThr+1) / nThreads;
+        threads.push_back(std::thread(Unfolding_FillWorker, first, last, &partial[iThr]));
+    }
+    for(Int_t iThr = 0; iThr < nThreads; iThr++) threads[iThr].join();
+    // merge the partial counts
+    Unfolding_foldCounts.assign(nFolds * Unfolding_FoldSize(), 0.);
+    for(Int_t iThr = 0; iThr < nThreads; iThr++)
+        for(UInt_t i = 0; i < Unfolding_foldCounts.size(); i++) Unfolding_foldCounts[i] += partial[iThr][i];
+
+    return;
+}
+
+// response trained on all folds except iTestFold (with under/overflow bins)
+RooUnfoldResponse* Unfolding_NewResponse(Int_t iTestFold)
+{
+    Int_t nB = Unfolding_nBins + 2;
+    Int_t size = Unfolding_FoldSize();
+    Float_t* edges = Unfolding_edges.data();
+    TH1D* hMeas = new TH1D("Unfolding_hMeas", "", Unfolding_nBins, edges);
+    TH1D* hTrue = new TH1D("Unfolding_hTrue", "", Unfolding_nBins, edges);
+    TH2D* hResp = new TH2D("Unfolding_hResp", "", Unfolding_nBins, edges, Unfolding_nBins, edges);
+    for(Int_t iFold = 0; iFold < Unfolding_nFolds; iFold++)
+    {
+        if(iFold == iTestFold) continue;
+        Double_t* c = &Unfolding_foldCounts[iFold * size];
+        for(Int_t i = 0; i < nB; i++)
+        {
+            hMeas->SetBinContent(i, hMeas->GetBinContent(i) + c[i]);
+            hTrue->SetBinContent(i, hTrue->GetBinContent(i) + c[nB + i]);
+            for(Int_t j = 0; j < nB; j++) hResp->SetBinContent(i, j, hResp->GetBinContent(i, j) + c[2*nB + i*nB + j]);
+        }
+    }
+    RooUnfoldResponse* resp = new RooUnfoldResponse(hMeas, hTrue, hResp);
+    resp->UseOverflow(kTRUE);
+    delete hMeas;
+    delete hTrue;
+    delete hResp;
+
+    return resp;
+}
+
+// testing spectra of the fold iTestFold (with under/overflow bins)
+void Unfolding_TestSpectra(Int_t iTestFold, TH1F* hTestRec, TH1F* hTestGen)
+{
+    Int_t nB = Unfolding_nBins + 2;
+    Double_t* c = &Unfolding_foldCounts[iTestFold * Unfolding_FoldSize()];
+    hTestRec->Reset();
+    hTestGen->Reset();
+    for(Int_t i = 0; i < nB; i++)
+    {
+        hTestRec->SetBinContent(i, c[i]);
+        hTestGen->SetBinContent(i, c[nB + i]);
+    }
+
+    return;
+}
+
+// results of the last call of Unfolding_Bayes: index = number of iterations - 1
+// (always nIterMax elements, see Unfolding_Bayes)
+std::vector<TVectorD> Unfolding_val;
+std::vector<TMatrixD> Unfolding_cov;
+
+// index of the histogram bin corresponding to the element iVec of the vectors
+Int_t Unfolding_HistBin(Int_t iVec, Bool_t overflow)
+{
+    return overflow ? iVec : iVec + 1;
+}
+
+void Unfolding_Bayes(RooUnfoldResponse* resp, TH1* hRec, Int_t nIterMax)
+{
+    TMatrixD R = resp->Mresponse(); // R(j,i) = P(measured in bin j | true in bin i)
+    TVectorD truth = resp->Vtruth(); // prior for the first iteration
+    Int_t nM = R.GetNrows();
+    Int_t nT = R.GetNcols();
+    Bool_t overflow = (nM == hRec->GetNbinsX() + 2);
+
+    // measured spectrum and its (diagonal) covariance
+    TVectorD n(nM);
+    TVectorD varN(nM);
+    for(Int_t j = 0; j < nM; j++)
+    {
+        n[j] = hRec->GetBinContent(Unfolding_HistBin(j, overflow));
+        varN[j] = TMath::Power(hRec->GetBinError(Unfolding_HistBin(j, overflow)), 2);
+    }
+    // efficiencies
+    TVectorD eff(nT);
+    for(Int_t i = 0; i < nT; i++) for(Int_t j = 0; j < nM; j++) eff[i] += R(j,i);
+
+    // prior (probabilities) and its derivative with respect to the measured spectrum
+    TVectorD p(nT);
+    Double_t sumTruth = truth.Sum();
+    for(Int_t i = 0; i < nT; i++) p[i] = sumTruth > 0 ? truth[i] / sumTruth : 1. / nT;
+    TMatrixD dp(nT, nM); // zero for the first iteration (prior from MC)
+
+    Unfolding_val.clear();
+    Unfolding_cov.clear();
+    TVectorD nUnf(nT);
+    TMatrixD D(nT, nM); // derivatives of the unfolded spectrum with respect to the measured one
+    TMatrixD theta(nT, nM);
+    TVectorD f(nM);
+    for(Int_t iIt = 0; iIt < nIterMax; iIt++)
+    {
+        // Bayes theorem: theta(i,j) = P(true in bin i | measured in bin j)
+        for(Int_t j = 0; j < nM; j++)
+        {
+            f[j] = 0;
+            for(Int_t i = 0; i < nT; i++) f[j] += R(j,i) * p[i];
+            for(Int_t i = 0; i < nT; i++) theta(i,j) = f[j] > 0 ? R(j,i) * p[i] / f[j] : 0.;
+        }
+        // unfolded spectrum
+        for(Int_t i = 0; i < nT; i++)
+        {
+            nUnf[i] = 0;
+            if(eff[i] <= 0) continue;
+            for(Int_t j = 0; j < nM; j++) nUnf[i] += theta(i,j) * n[j];
+            nUnf[i] /= eff[i];
+        }
+        // derivatives: direct term + term from the prior obtained in the previous iteration
+        for(Int_t i = 0; i < nT; i++)
+        {
+            for(Int_t k = 0; k < nM; k++)
+            {
+                D(i,k) = 0;
+                if(eff[i] <= 0) continue;
+                Double_t sum = theta(i,k);
+                if(iIt > 0) for(Int_t l = 0; l < nT; l++)
+                {
+                    // A(i,l) = sum_j n_j dtheta(i,j)/dp_l
+                    Double_t A = (i == l && p[i] > 0) ? eff[i] * nUnf[i] / p[i] : 0.;
+                    for(Int_t j = 0; j < nM; j++) if(f[j] > 0) A -= n[j] * theta(i,j) * R(j,l) / f[j];
+                    sum += A * dp(l,k);
+                }
+                D(i,k) = sum / eff[i];
+            }
+        }
+        // covariance: V = D V_n D^T
+        TMatrixD V(nT, nT);
+        for(Int_t i = 0; i < nT; i++)
+            for(Int_t l = 0; l < nT; l++)
+                for(Int_t k = 0; k < nM; k++) V(i,l) += D(i,k) * varN[k] * D(l,k);
+        Unfolding_val.push_back(nUnf);
+        Unfolding_cov.push_back(V);
+
+        // prior for the next iteration (its normalization does not change theta)
+        Double_t sumUnf = nUnf.Sum();
+        if(sumUnf <= 0)
+        {
+            // empty unfolded spectrum: the prior cannot be updated, the remaining iterations repeat this result
+            while((Int_t)Unfolding_val.size() < nIterMax)
+            {
+                Unfolding_val.push_back(nUnf);
+                Unfolding_cov.push_back(V);
+            }
+            break;
+        }
+        for(Int_t i = 0; i < nT; i++)
+        {
+            p[i] = nUnf[i] / sumUnf;
+            for(Int_t k = 0; k < nM; k++) dp(i,k) = D(i,k) / sumUnf;
+        }
+    }
+
+    return;
+}
+
+// SVD (regularisation parameter kReg) or bin-by-bin (kReg ignored) with RooUnfold
+void Unfolding_RooUnfold(RooUnfoldResponse* resp, TH1* hRec, TString unf, Int_t kReg)
+{
+    RooUnfold* unfold = NULL;
+    if(unf == "Svd") unfold = new RooUnfoldSvd(resp, hRec, kReg);
+    else             unfold = new RooUnfoldBinByBin(resp, hRec);
+    Unfolding_val.clear();
+    Unfolding_cov.clear();
+    Unfolding_val.push_back(unfold->Vreco());
+    Unfolding_cov.push_back(unfold->Ereco());
+    delete unfold;
+
+    return;
+}
+
+// histogram with the unfolded spectrum of the step iStep (errors = sqrt of the diagonal of the covariance)
+TH1F* Unfolding_Histogram(TH1* hRec, Int_t iStep, TString name)
+{
+    TH1F* h = (TH1F*)hRec->Clone(name.Data());
+    h->Reset();
+    Int_t nT = Unfolding_val[iStep].GetNrows();
+    Bool_t overflow = (nT == hRec->GetNbinsX() + 2);
+    for(Int_t i = 0; i < nT; i++)
+    {
+        h->SetBinContent(Unfolding_HistBin(i, overflow), Unfolding_val[iStep][i]);
+        h->SetBinError(Unfolding_HistBin(i, overflow), TMath::Sqrt(Unfolding_cov[iStep](i,i)));
+    }
+
+    return h;
+}
+
+#endif
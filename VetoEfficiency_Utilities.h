@@ -15,6 +15,7 @@
 #include "AnalysisManager.h"
 #include "AnalysisConfig.h"
 #include "SetPtBinning.h"
+#include "StageCache.h"
 
 // tree variables:
 Bool_t fZNA_hit, fZNC_hit;
@@ -170,10 +171,14 @@ void VetoEfficiency_PrepareTree()
 {
     TString name = "Trees/" + str_subfolder + "VetoEfficiency/tNeutrons.root";
 
-    TFile *file = TFile::Open(name.Data(),"read");
-    if(file)
+    TString str_in = str_in_DT_fldr + "AnalysisResults.root";
+    // recreate the tree only if the input data, the selection or the cuts changed
+    TString key = StageCache_Key("VetoEfficiency_PrepareTree", 1, {str_in, "VetoEfficiency_Utilities.h", "AnalysisManager.h", "ListsOfGoodRuns.h"},
+                                 AnalysisConfig_ToString());
+    TFile *file = NULL;
+    if(StageCache_IsUpToDate(name, key))
     {
-        Printf("Tree already created.");
+        Printf("Tree already created and up to date.");
         return;
     } 
     else 
@@ -181,7 +186,7 @@ void VetoEfficiency_PrepareTree()
         Printf("Tree will be created.");
 
         // data
-        TFile *f_in = TFile::Open((str_in_DT_fldr + "AnalysisResults.root").Data(), "read");
+        TFile *f_in = TFile::Open(str_in.Data(), "read");
         if(f_in) Printf("Input data loaded.");
 
         TTree *t_in = dynamic_cast<TTree*> (f_in->Get(str_in_DT_tree.Data()));
@@ -237,6 +242,7 @@ void VetoEfficiency_PrepareTree()
         Printf("Tree %s filled with %lli entries.", t_out->GetName(), t_out->GetEntries());
 
         file->Write("",TObject::kWriteDelete);
+        StageCache_Update(name, key, "VetoEfficiency_PrepareTree");
 
         return;
     }
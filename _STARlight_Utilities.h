@@ -14,6 +14,8 @@
 // needed by STARlight macros
 #include "TLorentzVector.h"
 #include "TClonesArray.h"
+// my headers
+#include "StageCache.h"
 
 Double_t fPtGm, fPtVM, fPtPm;
 TLorentzVector *parent;
@@ -49,9 +51,11 @@ void ConnectTreeVariables_tSL(TTree *tSL)
 void PrepareTreesPtGammaVMPom(Int_t nGenEv, TString folder_in, TString folder_out)
 {
 	TString name_out = folder_out + "tree_tPtGammaVMPom.root";
-    TFile *f_out = TFile::Open(name_out.Data(),"read");
-    if(f_out){
-        Printf("Tree %s already created.", name_out.Data());
+	// recreate the tree only if the STARlight output or the number of events changed
+	TString key = StageCache_Key("PrepareTreesPtGammaVMPom", 1, {folder_in + "PtGammaVMPom.txt", "_STARlight_Utilities.h"}, Form("nGenEv=%i;", nGenEv));
+    TFile *f_out = NULL;
+    if(StageCache_IsUpToDate(name_out, key)){
+        Printf("Tree %s already created and up to date.", name_out.Data());
         return;
 
     } else {  
@@ -98,6 +102,7 @@ void PrepareTreesPtGammaVMPom(Int_t nGenEv, TString folder_in, TString folder_ou
 			f_out->Close();
 			delete f_out;
 		}
+		StageCache_Update(name_out, key, "PrepareTreesPtGammaVMPom");
 
 		Printf("*****");
 		Printf("Done.");